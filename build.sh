@@ -0,0 +1,45 @@
+#!/bin/sh
+# NOTE: Headless linux build. Produces linux_flux (platform) and flux.so (game)
+# Usage: ./build.sh [run] [release]
+
+set -e
+
+BinOutDir=build
+
+if [ "$1" = "run" ]; then
+    cd $BinOutDir
+    shift
+    ./linux_flux "$@"
+    exit 0
+fi
+
+if [ -z "$CXX" ]; then
+    if command -v clang++ >/dev/null 2>&1; then
+        CXX=clang++
+    else
+        CXX=g++
+    fi
+fi
+
+mkdir -p $BinOutDir
+
+CommonDefines="-DPLATFORM_LINUX"
+# NOTE: Existing code prints 32-bit values with %lu/%ld as on Windows and keeps unused locals around
+DisabledWarnings="-Wno-format -Wno-unused-variable -Wno-unused-but-set-variable -Wno-unused-value -Wno-switch -Wno-sign-compare"
+CommonCompilerFlags="-std=c++17 -fno-rtti -fno-exceptions -ffast-math -g -Wall $DisabledWarnings -I src"
+DebugCompilerFlags="-O0 -DPBR_DEBUG"
+ReleaseCompilerFlags="-O2"
+
+ConfigCompilerFlags=$DebugCompilerFlags
+if [ "$1" = "release" ]; then
+    ConfigCompilerFlags=$ReleaseCompilerFlags
+fi
+
+echo "Building platform..."
+$CXX -DPLATFORM_CODE $CommonDefines $CommonCompilerFlags $ConfigCompilerFlags src/LinuxPlatform.cpp -o $BinOutDir/linux_flux -lpthread -ldl &
+PlatformPid=$!
+
+echo "Building game..."
+$CXX $CommonDefines $CommonCompilerFlags $ConfigCompilerFlags -fPIC -shared src/GameEntry.cpp -o $BinOutDir/flux.so -lpthread
+
+wait $PlatformPid
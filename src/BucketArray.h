@@ -42,14 +42,14 @@ bucket_array_template_decl
 T* BucketArrayPush(bucket_array_decl* array) {
     T* result = nullptr;
     if (!array->firstBucket) {
-        array->firstBucket = (bucket_array_decl::Bucket*)array->allocator.Alloc(sizeof(bucket_array_decl::Bucket), alignof(bucket_array_decl::Bucket));
+        array->firstBucket = (typename bucket_array_decl::Bucket*)array->allocator.Alloc(sizeof(typename bucket_array_decl::Bucket), alignof(typename bucket_array_decl::Bucket));
         if (array->firstBucket) {
             array->firstBucket->at = 0;
             array->firstBucket->next = nullptr;
             array->bucketCount++;
         }
     } else if (array->firstBucket->at == BucketCapacity) {
-        auto newBlock = (bucket_array_decl::Bucket*)array->allocator.Alloc(sizeof(bucket_array_decl::Bucket), alignof(bucket_array_decl::Bucket));
+        auto newBlock = (typename bucket_array_decl::Bucket*)array->allocator.Alloc(sizeof(typename bucket_array_decl::Bucket), alignof(typename bucket_array_decl::Bucket));
         if (newBlock) {
             array->bucketCount++;
             newBlock->at = 0;
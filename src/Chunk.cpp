@@ -1,5 +1,7 @@
 #include "Chunk.h"
 
+static_assert(Chunk::BitShift - ChunkBlockEntityCell::BitShift == ChunkBlockEntityIndex::CellsPerAxisShift);
+
 template <typename F>
 void ForEach(EntityStorage* storage, F func) {
     auto entity = storage->first;
@@ -36,31 +38,333 @@ void EntityStorageUnlink(EntityStorage* storage, Entity* entity) {
     entity->nextInStorage = nullptr;
 }
 
-BlockValue* GetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z) {
-    BlockValue* result = chunk->blocks + (x + Chunk::Size * y + Chunk::Size * Chunk::Size * z);
+inline u32 GetChunkBlockIndex(u32 x, u32 y, u32 z) {
+    return x + Chunk::Size * y + Chunk::Size * Chunk::Size * z;
+}
+
+inline u32 GetChunkBlockPaletteIndex(ChunkBlockIndices* indices, u32 blockIndex) {
+    u32 result = 0;
+    if (indices) {
+        auto bits = indices->bitsPerBlock;
+        auto bit = blockIndex * bits;
+        result = (u32)(indices->words[bit >> 6] >> (bit & 63)) & ((1u << bits) - 1);
+    }
     return result;
 }
 
+inline void SetChunkBlockPaletteIndex(ChunkBlockIndices* indices, u32 blockIndex, u32 paletteIndex) {
+    auto bits = indices->bitsPerBlock;
+    auto bit = blockIndex * bits;
+    auto shift = bit & 63;
+    auto mask = (((u64)1 << bits) - 1) << shift;
+    auto word = indices->words + (bit >> 6);
+    *word = (*word & ~mask) | ((u64)paletteIndex << shift);
+}
+
+u32 GetChunkBlockIndexBits(u32 paletteCount) {
+    assert(paletteCount <= ChunkBlockStorage::MaxPaletteCount);
+    u32 bits = 0;
+    while ((1u << bits) < paletteCount) {
+        bits = bits ? bits * 2 : 1;
+    }
+    return bits;
+}
+
+ChunkBlockIndices* AllocateChunkBlockIndices(u32 bitsPerBlock) {
+    assert(bitsPerBlock);
+    auto wordCount = Chunk::BlockCount * bitsPerBlock / 64;
+    auto size = sizeof(ChunkBlockIndices) + sizeof(u64) * (wordCount - 1);
+    auto indices = (ChunkBlockIndices*)PlatformAlloc(size, 0, nullptr);
+    panic(indices, "[Chunk] Failed to allocate block indices");
+    indices->nextRetired = nullptr;
+    indices->bitsPerBlock = bitsPerBlock;
+    return indices;
+}
+
+void ReplaceChunkBlockIndices(Chunk* chunk, ChunkBlockIndices* newIndices, bool retireOld) {
+    auto storage = &chunk->blocks;
+    auto oldIndices = storage->indices;
+    // NOTE: Words should be visible before the pointer
+    WriteFence();
+    storage->indices = newIndices;
+    if (oldIndices) {
+        if (retireOld) {
+            oldIndices->nextRetired = storage->retired;
+            storage->retired = oldIndices;
+        } else {
+            PlatformFree(oldIndices, nullptr);
+        }
+    }
+}
+
+// NOTE: Values in the palette are distinct (a value which has a free slot gets it back), so it never overflows
+static_assert((u32)BlockValue::_Count <= ChunkBlockStorage::MaxPaletteCount);
+
+// NOTE: Jobs might be reading the blocks while the chunk is busy or has retired indices. They decode indices
+// with the live palette, so then slots keep their values: they are not compacted and not given to other values
+inline bool AreChunkPaletteSlotsPinned(Chunk* chunk, bool retireOld) {
+    return retireOld || chunk->blocks.retired;
+}
+
+// NOTE: Rewrites indices with the smallest width which fits max(slots, minPaletteCount).
+// Free palette slots are dropped unless slots are pinned
+void RepackChunkBlocks(Chunk* chunk, u32 minPaletteCount, bool retireOld) {
+    auto storage = &chunk->blocks;
+    u8 remap[ChunkBlockStorage::MaxPaletteCount];
+    if (AreChunkPaletteSlotsPinned(chunk, retireOld)) {
+        for (u32 i = 0; i < storage->paletteCount; i++) {
+            remap[i] = (u8)i;
+        }
+    } else {
+        u32 paletteCount = 0;
+        for (u32 i = 0; i < storage->paletteCount; i++) {
+            if (storage->refCounts[i]) {
+                remap[i] = (u8)paletteCount;
+                storage->palette[paletteCount] = storage->palette[i];
+                storage->refCounts[paletteCount] = storage->refCounts[i];
+                paletteCount++;
+            }
+        }
+        assert(paletteCount == storage->paletteUsedCount);
+        storage->paletteCount = paletteCount;
+    }
+
+    auto oldIndices = storage->indices;
+    ChunkBlockIndices* newIndices = nullptr;
+    auto bits = GetChunkBlockIndexBits(Max(storage->paletteCount, minPaletteCount));
+    if (bits) {
+        newIndices = AllocateChunkBlockIndices(bits);
+        auto blocksPerWord = 64 / bits;
+        auto wordCount = Chunk::BlockCount / blocksPerWord;
+        for (u32 w = 0; w < wordCount; w++) {
+            u64 word = 0;
+            for (u32 i = 0; i < blocksPerWord; i++) {
+                auto index = remap[GetChunkBlockPaletteIndex(oldIndices, w * blocksPerWord + i)];
+                word |= (u64)index << (i * bits);
+            }
+            newIndices->words[w] = word;
+        }
+    }
+    ReplaceChunkBlockIndices(chunk, newIndices, retireOld);
+}
+
+void SetChunkBlockValue(Chunk* chunk, u32 blockIndex, BlockValue value, bool retireOld) {
+    auto storage = &chunk->blocks;
+    assert(storage->paletteCount);
+    auto oldSlot = GetChunkBlockPaletteIndex(storage->indices, blockIndex);
+    if (storage->palette[oldSlot] != value) {
+        bool pinned = AreChunkPaletteSlotsPinned(chunk, retireOld);
+        u32 slot = U32::Max;
+        u32 freeSlot = U32::Max;
+        for (u32 i = 0; i < storage->paletteCount; i++) {
+            if (storage->palette[i] == value) {
+                slot = i;
+                break;
+            } else if (!storage->refCounts[i] && freeSlot == U32::Max) {
+                freeSlot = i;
+            }
+        }
+        if (slot == U32::Max) {
+            if (pinned || freeSlot == U32::Max) {
+                auto bits = storage->indices ? storage->indices->bitsPerBlock : 0;
+                if (storage->paletteCount == (1u << bits)) {
+                    // NOTE: No room for another slot, so this widens the indices
+                    RepackChunkBlocks(chunk, storage->paletteCount + 1, retireOld);
+                    // NOTE: Repacking might have moved the slot
+                    oldSlot = GetChunkBlockPaletteIndex(storage->indices, blockIndex);
+                }
+                freeSlot = storage->paletteCount++;
+            }
+            slot = freeSlot;
+            storage->palette[slot] = value;
+            storage->refCounts[slot] = 0;
+        }
+        if (!storage->refCounts[slot]) {
+            storage->paletteUsedCount++;
+        }
+        storage->refCounts[slot]++;
+        SetChunkBlockPaletteIndex(storage->indices, blockIndex, slot);
+        assert(storage->refCounts[oldSlot]);
+        storage->refCounts[oldSlot]--;
+        if (!storage->refCounts[oldSlot]) {
+            storage->paletteUsedCount--;
+            // NOTE: Shrinking only at a quarter of the capacity, so a value which comes and goes doesn't
+            // reencode the chunk on every edit. Chunks which are only half used are shrunk before saving
+            auto bits = storage->indices->bitsPerBlock;
+            if (!pinned && (storage->paletteUsedCount <= ((1u << bits) >> 2))) {
+                RepackChunkBlocks(chunk, 0, retireOld);
+            }
+        }
+    }
+}
+
+void ShrinkChunkBlocks(Chunk* chunk) {
+    assert(!chunk->locked);
+    assert(!chunk->saving);
+    auto storage = &chunk->blocks;
+    if (storage->indices && !storage->retired) {
+        auto bits = storage->indices->bitsPerBlock;
+        if (storage->paletteUsedCount <= ((1u << bits) >> 1)) {
+            RepackChunkBlocks(chunk, 0, false);
+        }
+    }
+}
+
+BlockValue GetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z) {
+    auto storage = &chunk->blocks;
+    auto slot = GetChunkBlockPaletteIndex(storage->indices, GetChunkBlockIndex(x, y, z));
+    return storage->palette[slot];
+}
+
+void SetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z, BlockValue value) {
+    SetChunkBlockValue(chunk, GetChunkBlockIndex(x, y, z), value, false);
+}
+
+void UnpackChunkBlocks(Chunk* chunk, BlockValue* values) {
+    auto storage = &chunk->blocks;
+    // NOTE: Loading the pointer once. Width comes with it
+    auto indices = storage->indices;
+    if (indices) {
+        auto bits = indices->bitsPerBlock;
+        auto mask = ((u64)1 << bits) - 1;
+        auto blocksPerWord = 64 / bits;
+        auto wordCount = Chunk::BlockCount / blocksPerWord;
+        for (u32 w = 0; w < wordCount; w++) {
+            auto word = indices->words[w];
+            for (u32 i = 0; i < blocksPerWord; i++) {
+                *values++ = storage->palette[word & mask];
+                word >>= bits;
+            }
+        }
+    } else {
+        auto value = storage->palette[0];
+        for (u32 i = 0; i < Chunk::BlockCount; i++) {
+            values[i] = value;
+        }
+    }
+}
+
+void PackChunkBlocks(Chunk* chunk, const BlockValue* values) {
+    auto storage = &chunk->blocks;
+    u32 paletteCount = 0;
+    u32 lastSlot = 0;
+    for (u32 i = 0; i < Chunk::BlockCount; i++) {
+        auto value = values[i];
+        if (!paletteCount || storage->palette[lastSlot] != value) {
+            lastSlot = U32::Max;
+            for (u32 slot = 0; slot < paletteCount; slot++) {
+                if (storage->palette[slot] == value) {
+                    lastSlot = slot;
+                    break;
+                }
+            }
+            if (lastSlot == U32::Max) {
+                panic(paletteCount < ChunkBlockStorage::MaxPaletteCount, "[Chunk] Too many different blocks in a chunk");
+                lastSlot = paletteCount++;
+                storage->palette[lastSlot] = value;
+                storage->refCounts[lastSlot] = 0;
+            }
+        }
+        storage->refCounts[lastSlot]++;
+    }
+    storage->paletteCount = paletteCount;
+    storage->paletteUsedCount = paletteCount;
+
+    ChunkBlockIndices* indices = nullptr;
+    auto bits = GetChunkBlockIndexBits(paletteCount);
+    if (bits) {
+        indices = AllocateChunkBlockIndices(bits);
+        auto blocksPerWord = 64 / bits;
+        auto wordCount = Chunk::BlockCount / blocksPerWord;
+        for (u32 w = 0; w < wordCount; w++) {
+            u64 word = 0;
+            for (u32 i = 0; i < blocksPerWord; i++) {
+                auto value = values[w * blocksPerWord + i];
+                u32 slot = 0;
+                while (storage->palette[slot] != value) slot++;
+                word |= (u64)slot << (i * bits);
+            }
+            indices->words[w] = word;
+        }
+    }
+    ReplaceChunkBlockIndices(chunk, indices, false);
+}
+
+bool IsChunkUniform(Chunk* chunk, BlockValue* value) {
+    auto storage = &chunk->blocks;
+    bool uniform = storage->indices == nullptr;
+    if (uniform && value) {
+        *value = storage->palette[0];
+    }
+    return uniform;
+}
+
+void SetChunkBlocksUniform(Chunk* chunk, BlockValue value) {
+    auto storage = &chunk->blocks;
+    storage->palette[0] = value;
+    storage->refCounts[0] = (u16)Chunk::BlockCount;
+    storage->paletteCount = 1;
+    storage->paletteUsedCount = 1;
+    ReplaceChunkBlockIndices(chunk, nullptr, false);
+}
+
+void FreeRetiredChunkBlockIndices(Chunk* chunk) {
+    assert(!chunk->locked);
+    assert(!chunk->saving);
+    auto indices = chunk->blocks.retired;
+    while (indices) {
+        auto next = indices->nextRetired;
+        PlatformFree(indices, nullptr);
+        indices = next;
+    }
+    chunk->blocks.retired = nullptr;
+}
+
+void FreeChunkBlockStorage(Chunk* chunk) {
+    FreeRetiredChunkBlockIndices(chunk);
+    ReplaceChunkBlockIndices(chunk, nullptr, false);
+}
+
 BlockValue GetBlockValue(Chunk* chunk, u32 x, u32 y, u32 z) {
-    const BlockValue* result = nullptr;
+    BlockValue result = chunk->nullBlockValue;
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
         result = GetBlockValueRaw(chunk, x, y, z);
-    } else {
-        result = &chunk->nullBlockValue;
     }
-    return *result;
+    return result;
+}
+
+inline u32 GetChunkBlockEntityCellIndex(u32 x, u32 y, u32 z) {
+    constexpr u32 shift = ChunkBlockEntityCell::BitShift;
+    constexpr u32 axisShift = ChunkBlockEntityIndex::CellsPerAxisShift;
+    return (x >> shift) | ((y >> shift) << axisShift) | ((z >> shift) << (axisShift * 2));
 }
 
+inline u32 GetChunkBlockEntityIndexInCell(u32 x, u32 y, u32 z) {
+    constexpr u32 mask = ChunkBlockEntityCell::BitMask;
+    constexpr u32 shift = ChunkBlockEntityCell::BitShift;
+    return (x & mask) | ((y & mask) << shift) | ((z & mask) << (shift * 2));
+}
+
+// NOTE: Returns null if there is no cell for this block, so nothing lives there
 BlockEntity** GetBlockEntityRaw(Chunk* chunk, u32 x, u32 y, u32 z) {
     BlockEntity** result = nullptr;
-    result = chunk->livingEntities + (x + Chunk::Size * y + Chunk::Size * Chunk::Size * z);
+    auto index = chunk->blockEntities;
+    if (index) {
+        auto cell = index->cells[GetChunkBlockEntityCellIndex(x, y, z)];
+        if (cell) {
+            result = cell->entities + GetChunkBlockEntityIndexInCell(x, y, z);
+        }
+    }
     return result;
 }
 
 BlockEntity* GetBlockEntity(Chunk* chunk, u32 x, u32 y, u32 z) {
     BlockEntity* result = nullptr;
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
-        result = *GetBlockEntityRaw(chunk, x, y, z);
+        auto entity = GetBlockEntityRaw(chunk, x, y, z);
+        if (entity) {
+            result = *entity;
+        }
     }
     return result;
 }
@@ -68,10 +372,9 @@ BlockEntity* GetBlockEntity(Chunk* chunk, u32 x, u32 y, u32 z) {
 Block GetBlock(Chunk* chunk, u32 x, u32 y, u32 z) {
     Block block { chunk->nullBlockValue, nullptr };
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
-        auto value = GetBlockValueRaw(chunk, x, y, z);
         auto entity = GetBlockEntityRaw(chunk, x, y, z);
-        block.value = *value;
-        block.entity = *entity;
+        block.value = GetBlockValueRaw(chunk, x, y, z);
+        block.entity = entity ? *entity : nullptr;
     }
     return block;
 }
@@ -79,11 +382,27 @@ Block GetBlock(Chunk* chunk, u32 x, u32 y, u32 z) {
 bool OccupyBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z) {
     bool result = false;
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
-        auto livingEntity = GetBlockEntityRaw(chunk, x, y, z);
+        auto index = chunk->blockEntities;
+        if (!index) {
+            index = (ChunkBlockEntityIndex*)PlatformAllocClear(sizeof(ChunkBlockEntityIndex));
+            panic(index, "[Chunk] Failed to allocate block entity index");
+            chunk->blockEntities = index;
+        }
+        auto cellIndex = GetChunkBlockEntityCellIndex(x, y, z);
+        auto cell = index->cells[cellIndex];
+        if (!cell) {
+            cell = (ChunkBlockEntityCell*)PlatformAllocClear(sizeof(ChunkBlockEntityCell));
+            panic(cell, "[Chunk] Failed to allocate block entity cell");
+            index->cells[cellIndex] = cell;
+            index->cellCount++;
+        }
+        auto livingEntity = cell->entities + GetChunkBlockEntityIndexInCell(x, y, z);
         if (!(*livingEntity)) {
             *livingEntity = entity;
+            cell->count++;
             if (entity->flags & EntityFlag_PropagatesSim) {
                 chunk->simPropagationCount++;
+                WakeChunk(chunk);
             }
             result = true;
         }
@@ -94,7 +413,12 @@ bool OccupyBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z) {
 bool ReleaseBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z) {
     bool result = false;
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
-        auto ptr = GetBlockEntityRaw(chunk, x, y, z);
+        auto index = chunk->blockEntities;
+        assert(index);
+        auto cellIndex = GetChunkBlockEntityCellIndex(x, y, z);
+        auto cell = index->cells[cellIndex];
+        assert(cell);
+        auto ptr = cell->entities + GetChunkBlockEntityIndexInCell(x, y, z);
         assert(*ptr);
         auto livingEntity = *ptr;
         // Only entity that lives here allowed to release voxel
@@ -104,6 +428,19 @@ bool ReleaseBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z) {
             if (entity->flags & EntityFlag_PropagatesSim) {
                 assert(chunk->simPropagationCount > 0);
                 chunk->simPropagationCount--;
+                WakeChunk(chunk);
+            }
+            assert(cell->count);
+            cell->count--;
+            if (!cell->count) {
+                PlatformFree(cell, nullptr);
+                index->cells[cellIndex] = nullptr;
+                assert(index->cellCount);
+                index->cellCount--;
+                if (!index->cellCount) {
+                    PlatformFree(index, nullptr);
+                    chunk->blockEntities = nullptr;
+                }
             }
             result = true;
         }
@@ -111,16 +448,155 @@ bool ReleaseBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z) {
     return result;
 }
 
-BlockValue* GetBlockForModification(Chunk* chunk, u32 x, u32 y, u32 z) {
-    BlockValue* result = nullptr;
+void FreeChunkBlockEntityIndex(Chunk* chunk) {
+    auto index = chunk->blockEntities;
+    if (index) {
+        for (u32 i = 0; i < array_count(index->cells); i++) {
+            if (index->cells[i]) {
+                PlatformFree(index->cells[i], nullptr);
+            }
+        }
+        PlatformFree(index, nullptr);
+        chunk->blockEntities = nullptr;
+    }
+}
+
+// NOTE: Row and bit of the block in the side mask, see GetChunkSideMask
+inline void GetChunkSideMaskBit(u32 side, u32 x, u32 y, u32 z, u32* row, u32* bit) {
+    switch (side) {
+    case ChunkSide_Up: case ChunkSide_Down: { *row = z; *bit = x; } break;
+    case ChunkSide_Left: case ChunkSide_Right: { *row = z; *bit = y; } break;
+    case ChunkSide_Front: case ChunkSide_Back: { *row = y; *bit = x; } break;
+    invalid_default();
+    }
+}
+
+void GetChunkSideMask(Chunk* chunk, u32 side, u32* rows) {
+    constexpr u32 last = Chunk::Size - 1;
+    BlockValue uniformValue;
+    if (IsChunkUniform(chunk, &uniformValue)) {
+        u32 row = uniformValue != BlockValue::Empty ? 0xffffffff : 0;
+        for (u32 i = 0; i < Chunk::Size; i++) {
+            rows[i] = row;
+        }
+    } else {
+        u32 layer = (side == ChunkSide_Up || side == ChunkSide_Right || side == ChunkSide_Front) ? last : 0;
+        for (u32 j = 0; j < Chunk::Size; j++) {
+            u32 row = 0;
+            for (u32 i = 0; i < Chunk::Size; i++) {
+                BlockValue value;
+                switch (side) {
+                case ChunkSide_Up: case ChunkSide_Down: { value = GetBlockValueRaw(chunk, i, layer, j); } break;
+                case ChunkSide_Left: case ChunkSide_Right: { value = GetBlockValueRaw(chunk, layer, i, j); } break;
+                case ChunkSide_Front: case ChunkSide_Back: { value = GetBlockValueRaw(chunk, i, j, layer); } break;
+                invalid_default();
+                }
+                if (value != BlockValue::Empty) {
+                    row |= 1u << i;
+                }
+            }
+            rows[j] = row;
+        }
+    }
+}
+
+void SnapshotChunkMeshBorders(Chunk* chunk) {
+    for (u32 side = 0; side < ChunkSide_Count; side++) {
+        auto neighbor = chunk->neighbors[ChunkSideNeighborIndex(side)];
+        if (neighbor && neighbor->filled) {
+            GetChunkSideMask(neighbor, side ^ 1, chunk->meshBorders[side]);
+        } else {
+            memset(chunk->meshBorders[side], 0, sizeof(chunk->meshBorders[side]));
+        }
+    }
+    chunk->meshBordersChanged = false;
+}
+
+// NOTE: Visible chunk has a mesh made against its border snapshot if the mesh is valid or meshing is in flight.
+// Otherwise the snapshot is taken when meshing is scheduled, so there is nothing to invalidate
+void InvalidateChunkMeshBorders(Chunk* chunk) {
+    if (chunk->visible) {
+        if (chunk->filled) {
+            if (chunk->primaryMeshValid || chunk->locked) {
+                chunk->shouldBeRemeshedAfterEdit = true;
+                WakeChunk(chunk);
+            }
+        } else if (chunk->locked && chunk->meshAfterFill) {
+            chunk->meshBordersChanged = true;
+        }
+    }
+}
+
+void UpdateNeighborMeshBorders(Chunk* chunk) {
+    assert(chunk->filled);
+    for (u32 side = 0; side < ChunkSide_Count; side++) {
+        auto neighbor = chunk->neighbors[ChunkSideNeighborIndex(side)];
+        if (neighbor && neighbor->visible) {
+            u32 rows[Chunk::Size];
+            GetChunkSideMask(chunk, side, rows);
+            if (memcmp(rows, neighbor->meshBorders[side ^ 1], sizeof(rows)) != 0) {
+                InvalidateChunkMeshBorders(neighbor);
+            }
+        }
+    }
+}
+
+// NOTE: Block on the chunk side is in the border snapshot of the neighbor on that side
+void UpdateNeighborMeshBorders(Chunk* chunk, u32 x, u32 y, u32 z, BlockValue value) {
+    constexpr u32 last = Chunk::Size - 1;
+    u32 coords[3] = { x, y, z };
+    for (u32 axis = 0; axis < 3; axis++) {
+        if (coords[axis] == 0 || coords[axis] == last) {
+            u32 side;
+            switch (axis) {
+            case 0: { side = coords[axis] ? ChunkSide_Right : ChunkSide_Left; } break;
+            case 1: { side = coords[axis] ? ChunkSide_Up : ChunkSide_Down; } break;
+            case 2: { side = coords[axis] ? ChunkSide_Front : ChunkSide_Back; } break;
+            invalid_default();
+            }
+            auto neighbor = chunk->neighbors[ChunkSideNeighborIndex(side)];
+            if (neighbor) {
+                u32 row, bit;
+                GetChunkSideMaskBit(side, x, y, z, &row, &bit);
+                bool snapshotted = neighbor->meshBorders[side ^ 1][row] & (1u << bit);
+                if (snapshotted != (value != BlockValue::Empty)) {
+                    InvalidateChunkMeshBorders(neighbor);
+                }
+            }
+        }
+    }
+}
+
+bool ModifyBlock(Chunk* chunk, u32 x, u32 y, u32 z, BlockValue value) {
+    bool result = false;
     if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size) {
-        result = GetBlockValueRaw(chunk, x, y, z);
+        // NOTE: Meshing or save work might be reading the indices right now
+        bool busy = chunk->locked || chunk->saving;
+        if (!busy && chunk->blocks.retired) {
+            FreeRetiredChunkBlockIndices(chunk);
+        }
+        SetChunkBlockValue(chunk, GetChunkBlockIndex(x, y, z), value, busy);
         chunk->shouldBeRemeshedAfterEdit = true;
+        UpdateNeighborMeshBorders(chunk, x, y, z, value);
         chunk->lastModificationTick = GetPlatform()->tickCount;
+        WakeChunk(chunk);
+        result = true;
     }
     return result;
 }
 
+void* GetChunkJobHandle(Chunk* chunk) {
+    return (void*)(uptr)chunk->generation;
+}
+
+bool IsChunkJobCancelled(Chunk* chunk, void* handle) {
+    return chunk->generation != (u32)(uptr)handle;
+}
+
+void CancelChunkJobs(Chunk* chunk) {
+    AtomicIncrement(&chunk->generation);
+}
+
 const char* ToString(ChunkState state) {
     switch (state) {
     case ChunkState::Complete: { return "Complete"; } break;
@@ -131,16 +607,8 @@ const char* ToString(ChunkState state) {
     case ChunkState::WaitsForUpload: { return "WaitsForUpload"; } break;
     case ChunkState::MeshUploadingFinished: { return "MeshUploadingFinished"; } break;
     case ChunkState::UploadingMesh: { return "UploadingMesh"; } break;
+    case ChunkState::Cancelled: { return "Cancelled"; } break;
     invalid_default();
     }
     return "<unknown>";
 }
-
-const char* ToString(ChunkPriority state) {
-    switch (state) {
-    case ChunkPriority::Low: { return "Low"; } break;
-    case ChunkPriority::High: { return "High"; } break;
-        invalid_default();
-    }
-    return "<unknown>";
-}
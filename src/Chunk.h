@@ -15,11 +15,9 @@ enum struct ChunkState : u32 {
     WaitsForUpload,
     MeshUploadingFinished,
     FailedToPushUploadWork,
-    UploadingMesh
-};
-
-enum struct ChunkPriority : u32 {
-    Low = 0, High
+    UploadingMesh,
+    // NOTE: Fill or meshing job found out that it was cancelled and did nothing
+    Cancelled
 };
 
 // NOTE: Storing entities as linked list for now
@@ -34,36 +32,115 @@ void EntityStorageUnlink(EntityStorage* storage, Entity* entity);
 template <typename F>
 void ForEach(EntityStorage* storage, F func);
 
+// NOTE: Packed palette indices. Width is 1, 2, 4 or 8 bits, so an index never straddles a word.
+// Width lives with the words, so a reader which loaded the pointer once always sees a matching pair
+struct ChunkBlockIndices {
+    // NOTE: Replaced arrays are retired instead of freed while jobs might still read them
+    ChunkBlockIndices* nextRetired;
+    u32 bitsPerBlock;
+    u64 words[1];
+};
+
+// NOTE: Block values are stored as indices into a per-chunk palette. Index width grows
+// with the palette and shrinks back when values disappear. Without indices (zero width)
+// every block is palette[0]. Storage is valid only after it was packed or set uniform
+struct ChunkBlockStorage {
+    static const u32 MaxPaletteCount = 256;
+
+    // NOTE: Slots with zero reference count are free. They are reused and compacted only when no job
+    // reads the blocks, otherwise jobs reading old indices with the live palette would see other values
+    u32 paletteCount;
+    u32 paletteUsedCount;
+    BlockValue palette[MaxPaletteCount];
+    u16 refCounts[MaxPaletteCount];
+    ChunkBlockIndices* volatile indices;
+    ChunkBlockIndices* retired;
+};
+
+// NOTE: Two-level grid of block entities living in the chunk. Chunk is split into 8^3 cells,
+// a cell is allocated when the first entity occupies a block in it and freed with the last one.
+// Lookup is two loads, so dense factories stay as fast as with a flat grid
+struct ChunkBlockEntityCell {
+    static const u32 BitShift = 3;
+    static const u32 BitMask = (1 << BitShift) - 1;
+    static const u32 Size = 1 << BitShift;
+
+    u32 count;
+    BlockEntity* entities[Size * Size * Size];
+};
+
+struct ChunkBlockEntityIndex {
+    // NOTE: Chunk::BitShift - ChunkBlockEntityCell::BitShift
+    static const u32 CellsPerAxisShift = 2;
+    static const u32 CellsPerAxis = 1 << CellsPerAxisShift;
+
+    u32 cellCount;
+    ChunkBlockEntityCell* cells[CellsPerAxis * CellsPerAxis * CellsPerAxis];
+};
+
+constant u32 ChunkNeighborCount = 27;
+constant u32 ChunkNeighborSelf = 13;
+
+// NOTE: Offsets are in [-1, 1]. Opposite neighbor is at (ChunkNeighborCount - 1 - index)
+inline u32 ChunkNeighborIndex(i32 dx, i32 dy, i32 dz) { return (u32)((dx + 1) + (dy + 1) * 3 + (dz + 1) * 9); }
+
+// NOTE: Sides of the chunk in the order of mesher box faces. Opposite side is (side ^ 1)
+enum ChunkSide : u32 {
+    ChunkSide_Up = 0, ChunkSide_Down, ChunkSide_Left, ChunkSide_Right, ChunkSide_Front, ChunkSide_Back, ChunkSide_Count
+};
+
+constant i32 ChunkSideOffsets[ChunkSide_Count][3] = {
+    { 0, 1, 0 }, { 0, -1, 0 }, { -1, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 }
+};
+
+inline u32 ChunkSideNeighborIndex(u32 side) { return ChunkNeighborIndex(ChunkSideOffsets[side][0], ChunkSideOffsets[side][1], ChunkSideOffsets[side][2]); }
+
 struct Chunk {
     static const u32 BitShift = 5;
     static const u32 BitMask = (1 << BitShift) - 1;
     static const u32 Size = 1 << BitShift;
+    static const u32 BlockCount = Size * Size * Size;
 
     volatile u64 lastSaveTick;
     volatile ChunkState state;
     volatile u32 saving;
+    // NOTE: Jobs capture the generation when they are pushed. Bumping it cancels them
+    volatile u32 generation;
 
     b32 locked;
     b32 filled;
     b32 primaryMeshValid;
     b32 secondaryMeshValid;
     b32 remeshingAfterEdit;
-    ChunkPriority priority;
+    // NOTE: Last schedule priority (lower is sooner), only for debugging
+    f32 schedulePriority;
     b32 shouldBeRemeshedAfterEdit;
+    // NOTE: Set before fill work is pushed. Meshing is chained after the fill
+    b32 meshAfterFill;
+    // NOTE: Border of a neighbor changed while the chunk was filled and meshed by chained work.
+    // Turns into shouldBeRemeshedAfterEdit when the fill is done
+    b32 meshBordersChanged;
 
     u64 lastModificationTick;
     b32 active;
     b32 visible;
 
-    // TODO: Too many pointers here
-    Chunk* nextActive;
-    Chunk* prevActive;
-    Chunk* nextRendered;
-    Chunk* prevRendered;
-    Chunk* nextInEvictionList;
+    // NOTE: Indices of the chunk records in the chunk pool sets. Valid while the chunk is active or visible
+    u32 simRecordIndex;
+    u32 renderRecordIndex;
 
     Chunk* nextInFreeList;
 
+    // NOTE: Adjacent chunks which are in the world (not necessarily filled) or null. Linked both ways by
+    // AddChunk and DeleteChunk, so walking to a neighbor doesn't go to the hash map. Indexed with
+    // ChunkNeighborIndex, the middle one points to the chunk itself
+    Chunk* neighbors[ChunkNeighborCount];
+
+    // NOTE: Occupancy of the neighbor blocks touching each side (see GetChunkSideMask). Snapshotted on the main thread
+    // when meshing is scheduled, so meshing work never reads neighbors which might be edited meanwhile.
+    // Neighbors which are not filled are snapshotted empty
+    u32 meshBorders[ChunkSide_Count][Size];
+
     iv3 p;
     ChunkMesh* primaryMesh;
     ChunkMesh* secondaryMesh;
@@ -72,21 +149,40 @@ struct Chunk {
 
     u32 simPropagationCount;
 
+    // NOTE: Launches chained work (i.e. meshing after fill)
+    WorkCounter workCounter;
+
     EntityStorage entityStorage;
 
-    // TODO: Is separating block values and living entities actually a good idea?
-    BlockValue blocks[Size * Size * Size];
-    // NOTE: Just go bananas and storing pointer to block entity that lives in this voxel
-    // TODO: In the future we probably need some sophisticated structure for
-    // fast retrieval of entities by coords without storing 8 BYTE POINTER IN EVERY VOXEL WHICH
-    // MAKES EVERY CHUNK AT LEAST 0.25 MB BIGGER. Just static grid subdivision might be enough
-    // or there might be an octree in chunk of smth...
-    // TODO: Make this BlockEntity*
-    BlockEntity* livingEntities[Size * Size * Size];
+    // NOTE: Allocated on the first occupied block, so chunks without block entities don't pay for it
+    ChunkBlockEntityIndex* blockEntities;
     BlockValue nullBlockValue;
+
+    // NOTE: Payload. Everything above is the header which is cleared when chunk memory is reused.
+    // Payload is not cleared, fill or load work overwrites it before the chunk is filled.
+    // Index pointers are already null, since they are freed with the chunk
+    // TODO: Is separating block values and living entities actually a good idea?
+    ChunkBlockStorage blocks;
 };
 
-BlockValue* GetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z);
+// NOTE: No bounds checking. Reads go through the palette
+BlockValue GetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z);
+// NOTE: No bounds checking and no edit tracking. Only for the thread which owns the chunk (i.e. fill work)
+void SetBlockValueRaw(Chunk* chunk, u32 x, u32 y, u32 z, BlockValue value);
+// NOTE: Bulk conversion from and to flat Size^3 arrays (x + Size * y + Size * Size * z)
+void UnpackChunkBlocks(Chunk* chunk, BlockValue* values);
+void PackChunkBlocks(Chunk* chunk, const BlockValue* values);
+// NOTE: Uniform chunk is a chunk without block indices. All blocks are the same value and
+// real storage is materialized by the first edit which puts a different value
+bool IsChunkUniform(Chunk* chunk, BlockValue* value);
+void SetChunkBlocksUniform(Chunk* chunk, BlockValue value);
+// NOTE: Frees index arrays which were replaced while the chunk was busy. Chunk must not be locked or saving
+void FreeRetiredChunkBlockIndices(Chunk* chunk);
+// NOTE: Edits shrink indices lazily. Shrinks them to the smallest width which fits the used values (uniform
+// if only one is left). Chunk must not be locked or saving
+void ShrinkChunkBlocks(Chunk* chunk);
+void FreeChunkBlockStorage(Chunk* chunk);
+void FreeChunkBlockEntityIndex(Chunk* chunk);
 
 // Returns null block value if a block isn't exist
 BlockValue GetBlockValue(Chunk* chunk, u32 x, u32 y, u32 z);
@@ -99,13 +195,31 @@ Block GetBlock(Chunk* chunk, u32 x, u32 y, u32 z);
 inline Block GetBlock(Chunk* chunk, uv3 p) { return GetBlock(chunk, p.x, p.y, p.z); }
 
 
-BlockValue* GetBlockForModification(Chunk* chunk, u32 x, u32 y, u32 z);
-BlockValue* GetBlockForModification(Chunk* chunk, u32 x, u32 y, u32 z);
+// NOTE: Sets the block and marks the chunk for remeshing. Returns false if a block isn't exist
+bool ModifyBlock(Chunk* chunk, u32 x, u32 y, u32 z, BlockValue value);
+inline bool ModifyBlock(Chunk* chunk, uv3 p, BlockValue value) { return ModifyBlock(chunk, p.x, p.y, p.z, value); }
+
+// NOTE: Bit per non empty block of the chunk layer on the side. Rows are indexed like the block lines crossing
+// the side in the binary mesher: row z bit x for up and down, row z bit y for left and right, row y bit x for front and back
+void GetChunkSideMask(Chunk* chunk, u32 side, u32* rows);
+// NOTE: Main thread only. Called when meshing of the chunk is scheduled
+void SnapshotChunkMeshBorders(Chunk* chunk);
+// NOTE: Main thread only. Neighbors which were meshed against other borders are marked for remeshing
+void UpdateNeighborMeshBorders(Chunk* chunk);
+
+// NOTE: Chunk pool update skips chunks which have nothing to do. Changes made to a chunk outside of the pool
+// (edits, sim propagating entities) should wake it. Implemented by the chunk pool
+void WakeChunk(Chunk* chunk);
 
 bool OccupyBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z);
 inline bool OccupyBlock(Chunk* chunk, BlockEntity* entity, uv3 p) { return OccupyBlock(chunk, entity, p.x, p.y, p.z); }
 bool ReleaseBlock(Chunk* chunk, BlockEntity* entity, u32 x, u32 y, u32 z);
 inline bool ReleaseBlock(Chunk* chunk, BlockEntity* entity, uv3 p) { return ReleaseBlock(chunk, entity, p.x, p.y, p.z); }
 
+// NOTE: Handle is passed to the job as work data. Chunk can't be freed while it is locked,
+// so a job can always read the generation of its chunk
+void* GetChunkJobHandle(Chunk* chunk);
+bool IsChunkJobCancelled(Chunk* chunk, void* handle);
+void CancelChunkJobs(Chunk* chunk);
+
 const char* ToString(ChunkState state);
-const char* ToString(ChunkPriority state);
@@ -11,25 +11,108 @@ bool IsInside(iv3 min, iv3 max, iv3 x) {
     return result;
 }
 
+void InitChunkRings(ChunkRings* rings, u32 ringCount) {
+    rings->ringCount = ringCount;
+    rings->rings = (FlatArray<u32>*)PlatformAlloc(sizeof(FlatArray<u32>) * ringCount, 0, nullptr);
+    ClearArray(rings->rings, ringCount);
+    for (u32 i = 0; i < ringCount; i++) {
+        FlatArrayInit(rings->rings + i, MakeAllocator(PlatformAlloc, PlatformFree, nullptr), 64);
+    }
+}
+
+u32 GetChunkRing(ChunkRings* rings, iv3 origin, iv3 p) {
+    i32 dx = p.x - origin.x;
+    i32 dz = p.z - origin.z;
+    u32 distance = (u32)Max(dx < 0 ? -dx : dx, dz < 0 ? -dz : dz);
+    return Min(distance, rings->ringCount - 1);
+}
+
+template <typename Record>
+void ChunkRingsInsert(ChunkRings* rings, iv3 origin, FlatArray<Record>* records, u32 index) {
+    auto record = FlatArrayAtUnchecked(records, index);
+    record->ring = GetChunkRing(rings, origin, record->p);
+    auto ring = rings->rings + record->ring;
+    record->ringSlot = (u32)ring->count;
+    *FlatArrayPush(ring) = index;
+}
+
+template <typename Record>
+void ChunkRingsRemove(ChunkRings* rings, FlatArray<Record>* records, u32 index) {
+    auto record = FlatArrayAtUnchecked(records, index);
+    auto ring = rings->rings + record->ring;
+    auto slot = record->ringSlot;
+    assert(*FlatArrayAtUnchecked(ring, slot) == index);
+    FlatArrayUnorderedRemove(ring, slot);
+    if (slot < ring->count) {
+        FlatArrayAtUnchecked(records, *FlatArrayAtUnchecked(ring, slot))->ringSlot = slot;
+    }
+}
+
+template <typename Record>
+void ChunkRingsRebuild(ChunkRings* rings, iv3 origin, FlatArray<Record>* records) {
+    for (u32 i = 0; i < rings->ringCount; i++) {
+        FlatArrayClear(rings->rings + i);
+    }
+    for (u32 i = 0; i < records->count; i++) {
+        ChunkRingsInsert(rings, origin, records, i);
+    }
+}
+
+// NOTE: Swap-removes the record and fixes indices of the one which took its place
+template <typename Record>
+Record* RemoveChunkRecord(ChunkRings* rings, FlatArray<Record>* records, u32 index) {
+    Record* moved = nullptr;
+    ChunkRingsRemove(rings, records, index);
+    FlatArrayUnorderedRemove(records, index);
+    if (index < records->count) {
+        moved = FlatArrayAtUnchecked(records, index);
+        *FlatArrayAtUnchecked(rings->rings + moved->ring, moved->ringSlot) = index;
+    }
+    return moved;
+}
+
 void ReturnChunkMeshToPool(ChunkPool* pool, u32 index) {
     assert(pool->chunkMeshPoolFree < pool->maxRenderedChunkCount);
     pool->chunkMeshPoolFree++;
-    pool->chunkMeshPoolUsage[index] = false;
+    auto word = index / 64;
+    auto bit = 1ull << (index % 64);
+    assert(!(pool->chunkMeshPoolFreeMask[word] & bit));
+    pool->chunkMeshPoolFreeMask[word] |= bit;
+    pool->chunkMeshPoolFirstFreeWord = Min(pool->chunkMeshPoolFirstFreeWord, word);
     auto mesh = pool->chunkMeshPool + index;
     assert(!mesh->gpuMemoryMapped);
     FreeChunkMesh(pool->mesher, mesh);
     mesh->chunk = nullptr;
 }
 
+void WakeChunk(Chunk* chunk) {
+    if (chunk->active) {
+        auto pool = &GetWorld()->chunkPool;
+        auto record = FlatArrayAtUnchecked(&pool->simChunks, chunk->simRecordIndex);
+        assert(record->chunk == chunk);
+        record->flags &= ~ChunkSimRecordFlag_Settled;
+    }
+}
+
+// NOTE: Drawn mesh follows mesh validity, so the record is updated whenever meshes are swapped or validated
+void UpdateChunkRenderRecord(ChunkPool* pool, Chunk* chunk) {
+    assert(chunk->visible);
+    auto record = FlatArrayAtUnchecked(&pool->renderedChunks, chunk->renderRecordIndex);
+    assert(record->chunk == chunk);
+    if (chunk->primaryMeshValid) {
+        record->meshIndex = chunk->primaryMeshPoolIndex;
+    } else if (chunk->secondaryMeshValid) {
+        record->meshIndex = chunk->secondaryMeshPoolIndex;
+    } else {
+        record->meshIndex = ChunkRenderRecord::NoMesh;
+    }
+}
+
 void RemoveChunkFromRenderPool(ChunkPool* pool, Chunk* chunk) {
     assert(chunk->visible);
     assert(chunk->primaryMesh);
     assert(!chunk->secondaryMesh);
     assert(!chunk->locked);
-    auto prev = chunk->prevRendered;
-    auto next = chunk->nextRendered;
-    chunk->prevRendered = nullptr;
-    chunk->nextRendered = nullptr;
     chunk->visible = false;
 
     ReturnChunkMeshToPool(pool, chunk->primaryMeshPoolIndex);
@@ -38,44 +121,40 @@ void RemoveChunkFromRenderPool(ChunkPool* pool, Chunk* chunk) {
 
     assert(pool->renderedChunkCount);
     pool->renderedChunkCount--;
-    if (!prev) {
-        pool->firstRenderedChunk = next;
-        if (next) {
-            next->prevRendered = nullptr;
-        }
-    } else {
-        prev->nextRendered = next;
-        if (next) {
-            next->prevRendered = prev;
-        }
+    auto index = chunk->renderRecordIndex;
+    assert(FlatArrayAtUnchecked(&pool->renderedChunks, index)->chunk == chunk);
+    auto moved = RemoveChunkRecord(&pool->renderRings, &pool->renderedChunks, index);
+    if (moved) {
+        moved->chunk->renderRecordIndex = index;
     }
+    assert(pool->renderedChunks.count == pool->renderedChunkCount);
+    // NOTE: Chunk might be evicted now
+    WakeChunk(chunk);
 }
 
-void ChunkSaveWork(void* data0, void* data1, void* data2, u32 threadIndex) {
+void ChunkSaveWork(void* data0, void* data1, void* data2, u32 threadIndex, MemoryArena* scratch) {
     auto chunk = (Chunk*)data0;
-    auto pool = (ChunkPool*)data1;
-    auto saveResult = SaveChunk(chunk);
+    auto saveResult = SaveChunk(chunk, scratch);
     assert(saveResult);
     log_print("Finishing a save work for chunk (%ld, %ld, %ld)", chunk->p.x, chunk->p.y, chunk->p.z);
     // TODO: Maybe chunk->lastSaveTick should not be atomic since chunk->saving works as a lock?
     AtomicExchange(&chunk->lastSaveTick, GetPlatform()->tickCount);
     auto prev = AtomicExchange(&chunk->saving, (u32)0);
     assert(prev);
-    // TODO: valudate this counter
-    AtomicDecrement(&pool->pendingSavesCount);
 }
 
 void RemoveChunkFromSimPool(ChunkPool* pool, Chunk* chunk) {
+    auto index = chunk->simRecordIndex;
+    auto record = FlatArrayAtUnchecked(&pool->simChunks, index);
+    assert(record->chunk == chunk);
+    bool evicting = record->flags & ChunkSimRecordFlag_Evict;
+
     assert(!chunk->visible);
     assert(chunk->active);
-    assert(!chunk->simPropagationCount);
+    assert(!chunk->simPropagationCount || evicting);
     assert(!chunk->locked);
     assert(chunk->lastModificationTick <= chunk->lastSaveTick);
 
-    auto prev = chunk->prevActive;
-    auto next = chunk->nextActive;
-    chunk->prevActive = nullptr;
-    chunk->nextActive = nullptr;
     chunk->active = false;
 
     assert(chunk->primaryMesh == nullptr);
@@ -83,27 +162,21 @@ void RemoveChunkFromSimPool(ChunkPool* pool, Chunk* chunk) {
 
     assert(pool->simChunkCount);
     pool->simChunkCount--;
-
-    if (!prev) {
-        pool->firstSimChunk = next;
-        if (next) {
-            next->prevActive = nullptr;
-        }
-    } else {
-        prev->nextActive = next;
-        if (next) {
-            next->prevActive = prev;
-        }
+    auto moved = RemoveChunkRecord(&pool->simRings, &pool->simChunks, index);
+    if (moved) {
+        moved->chunk->simRecordIndex = index;
     }
+    assert(pool->simChunks.count == pool->simChunkCount);
 
     ForEach (&chunk->entityStorage, [&] (Entity* it) {
         UnregisterEntity(pool->world, it->id);
+        it->active = false;
     });
 
-    if (!chunk->simPropagationCount) {
+    if (!chunk->simPropagationCount || evicting) {
 #if 0
         if (chunk->lastModificationTick) {
-            auto saveResult = SaveChunk(chunk);
+            auto saveResult = SaveChunk(chunk, PlatformGetScratchArena());
             assert(saveResult);
         }
 #endif
@@ -112,66 +185,81 @@ void RemoveChunkFromSimPool(ChunkPool* pool, Chunk* chunk) {
 }
 
 void MakeRoomForChunkInRenderPool(ChunkPool* pool) {
-    Chunk* furthestChunkOutside = nullptr;
-    i32 furthestDistOutside = 0;
-
+    auto rings = &pool->renderRings;
     Chunk* furthestChunk = nullptr;
-    i32 furthestDist = 0;
-    Chunk* chunk = pool->firstRenderedChunk;
-    while (chunk) {
-        if (!chunk->locked && chunk->visible) {
-            i32 dist = LengthSq(pool->playerRegion.origin - chunk->p);
-            if (!IsInside(pool->playerRegion.min, pool->playerRegion.max, chunk->p)) {
-                if (dist > furthestDistOutside) {
-                    furthestDistOutside = dist;
-                    furthestChunkOutside = chunk;
-                }
-            }
-            if (dist > furthestDist) {
-                furthestDist = dist;
+    u32 furthestRing = 0;
+    for (u32 i = rings->ringCount; i > 0 && !furthestChunk; i--) {
+        auto ring = rings->rings + (i - 1);
+        for (usize slot = 0; slot < ring->count; slot++) {
+            auto record = FlatArrayAtUnchecked(&pool->renderedChunks, *FlatArrayAtUnchecked(ring, slot));
+            auto chunk = record->chunk;
+            assert(chunk->visible);
+            if (!chunk->locked) {
                 furthestChunk = chunk;
+                furthestRing = i - 1;
+                break;
             }
         }
-        chunk = chunk->nextRendered;
     }
 
-    //furthestChunkOutside = nullptr;
-
-    if (furthestChunkOutside) {
-        RemoveChunkFromRenderPool(pool, furthestChunkOutside);
-    } else {
-        //pool->maxChunkCount++;
+    assert(furthestChunk);
+    if (furthestRing <= pool->playerRegion.span) {
         log_print("[Render pool]: Warn! Chunk {%ld, %ld, %ld}, which is inside visible region was evicted from render pool\n", furthestChunk->p.x, furthestChunk->p.y, furthestChunk->p.z);
-        RemoveChunkFromRenderPool(pool, furthestChunk);
     }
+    RemoveChunkFromRenderPool(pool, furthestChunk);
 }
 
-void MakeRoomForChunkInSimPool(ChunkPool* pool) {
-    Chunk* furthestChunkOutside = nullptr;
-    i32 furthestDistOutside = 0;
+// NOTE: Entities of a simulated chunk might move into its neighbors, so they are kept while it runs
+bool IsChunkNextToSimulatedChunk(ChunkPool* pool, Chunk* chunk) {
+    bool result = false;
+    for (u32 i = 0; i < ChunkNeighborCount; i++) {
+        auto neighbor = chunk->neighbors[i];
+        if (neighbor && (neighbor != chunk) && neighbor->active && neighbor->simPropagationCount) {
+            auto record = FlatArrayAtUnchecked(&pool->simChunks, neighbor->simRecordIndex);
+            if (!(record->flags & ChunkSimRecordFlag_Evict)) {
+                result = true;
+                break;
+            }
+        }
+    }
+    return result;
+}
 
-    Chunk* chunk = pool->firstSimChunk;
-    while (chunk) {
-        if (!chunk->locked && !chunk->lastModificationTick &&(chunk->simPropagationCount == 0) && (!chunk->visible)) {
-            assert(!chunk->saving);
-            i32 dist = LengthSq(pool->playerRegion.origin - chunk->p);
-            if (!IsInside(pool->playerRegion.min, pool->playerRegion.max, chunk->p)) {
-                if (dist > furthestDistOutside) {
-                    furthestDistOutside = dist;
-                    furthestChunkOutside = chunk;
+// NOTE: Returns false if there is nothing to evict right now. Then the least recently used chunk outside
+// of the region which is pinned by sim propagating entities is marked for eviction. It gets saved first,
+// so the room appears on a later update
+bool MakeRoomForChunkInSimPool(ChunkPool* pool) {
+    auto rings = &pool->simRings;
+    ChunkSimRecord* leastRecentlyUsed = nullptr;
+    // NOTE: Rings past the span are outside of the region
+    for (u32 i = rings->ringCount - 1; i > pool->playerRegion.span; i--) {
+        auto ring = rings->rings + i;
+        for (usize slot = 0; slot < ring->count; slot++) {
+            auto record = FlatArrayAtUnchecked(&pool->simChunks, *FlatArrayAtUnchecked(ring, slot));
+            auto chunk = record->chunk;
+            if (!chunk->locked && !chunk->visible && !chunk->saving) {
+                if (!chunk->lastModificationTick && (chunk->simPropagationCount == 0) && !IsChunkNextToSimulatedChunk(pool, chunk)) {
+                    RemoveChunkFromSimPool(pool, chunk);
+                    return true;
+                }
+                if (!(record->flags & ChunkSimRecordFlag_Evict)) {
+                    if (!leastRecentlyUsed || (record->lastUseTick < leastRecentlyUsed->lastUseTick)) {
+                        leastRecentlyUsed = record;
+                    }
                 }
             }
         }
-        chunk = chunk->nextActive;
     }
 
-    if (furthestChunkOutside) {
-        RemoveChunkFromSimPool(pool, furthestChunkOutside);
+    if (leastRecentlyUsed) {
+        auto chunk = leastRecentlyUsed->chunk;
+        leastRecentlyUsed->flags |= ChunkSimRecordFlag_Evict;
+        leastRecentlyUsed->flags &= ~ChunkSimRecordFlag_Settled;
+        log_print("[Sim pool]: Pool is over budget. Evicting chunk (%ld, %ld, %ld) with %lu sim propagating entities\n", chunk->p.x, chunk->p.y, chunk->p.z, chunk->simPropagationCount);
     } else {
-        pool->maxSimChunkCount++;
-        log_print("[Sim pool]: Growing sim pool because all chunks either simulated or visible. New pool size: %lu\n", pool->maxSimChunkCount);
-        //RemoveChunkFromSimPool(pool, furthestChunk);
+        log_print("[Sim pool]: Pool is over budget (%lu chunks of %lu), but there is nothing to evict\n", pool->simChunkCount, pool->maxSimChunkCount);
     }
+    return false;
 }
 
 struct GetChunkMeshFromPoolResult {
@@ -181,45 +269,59 @@ struct GetChunkMeshFromPoolResult {
 
 GetChunkMeshFromPoolResult GetChunkMeshFromPool(ChunkPool* pool) {
     GetChunkMeshFromPoolResult result{};
-    i32 index = -1;
-    for (u32x i = 0; i < pool->maxRenderedChunkCount; i++) {
-        if (!pool->chunkMeshPoolUsage[i]) {
-            pool->chunkMeshPoolUsage[i] = 1;
-            index = i;
-            break;
+    if (pool->chunkMeshPoolFree) {
+        auto word = pool->chunkMeshPoolFirstFreeWord;
+        while (!pool->chunkMeshPoolFreeMask[word]) {
+            word++;
+            assert(word < pool->chunkMeshPoolMaskWordCount);
         }
-    }
-
-    if (index != -1) {
-        assert(pool->chunkMeshPoolFree);
+        pool->chunkMeshPoolFirstFreeWord = word;
+        auto mask = pool->chunkMeshPoolFreeMask[word];
+        auto index = word * 64 + CountTrailingZeros(mask);
+        assert(index < pool->maxRenderedChunkCount);
+        // NOTE: Clearing the lowest set bit
+        pool->chunkMeshPoolFreeMask[word] = mask & (mask - 1);
         pool->chunkMeshPoolFree--;
-        result = { pool->chunkMeshPool + index, (u32)index };
+        result = { pool->chunkMeshPool + index, index };
     }
     return result;
 }
 
+// NOTE: Walks the whole pool, so it's compiled in only on demand
 void ValidateChunkMeshPool(ChunkPool* pool) {
+#if defined(VALIDATE_CHUNK_MESH_POOL)
     u32 count = 0;
-    for (u32x i = 0; i < pool->maxRenderedChunkCount; i++) {
-        if (!pool->chunkMeshPoolUsage[i]) {
+    for (u32x i = 0; i < pool->chunkMeshPoolMaskWordCount; i++) {
+        auto mask = pool->chunkMeshPoolFreeMask[i];
+        if (i < pool->chunkMeshPoolFirstFreeWord) {
+            assert(!mask);
+        }
+        while (mask) {
+            auto index = i * 64 + CountTrailingZeros(mask);
+            assert(index < pool->maxRenderedChunkCount);
+            assert(!pool->chunkMeshPool[index].chunk);
+            mask &= mask - 1;
             count++;
         }
     }
     assert(count == pool->chunkMeshPoolFree);
+#endif
 }
 
 void AddChunkToRenderPool(ChunkPool* pool, Chunk* chunk) {
     assert(!chunk->visible);
-    assert(!chunk->prevRendered);
-    assert(!chunk->nextRendered);
     assert(!chunk->primaryMeshValid);
     chunk->visible = true;
-    chunk->nextRendered = pool->firstRenderedChunk;
-    if (chunk->nextRendered) {
-        chunk->nextRendered->prevRendered = chunk;
-    }
-    pool->firstRenderedChunk = chunk;
+    chunk->renderRecordIndex = (u32)pool->renderedChunks.count;
+    auto record = FlatArrayPush(&pool->renderedChunks);
+    record->p = chunk->p;
+    record->meshIndex = ChunkRenderRecord::NoMesh;
+    record->chunk = chunk;
+    ChunkRingsInsert(&pool->renderRings, pool->playerRegion.origin, &pool->renderedChunks, chunk->renderRecordIndex);
     pool->renderedChunkCount++;
+    assert(pool->renderedChunks.count == pool->renderedChunkCount);
+    // NOTE: Chunk needs a mesh now
+    WakeChunk(chunk);
 
     auto mesh = GetChunkMeshFromPool(pool);
     //log_print("Asign chunk mesh %lu to chunk (%ld, %ld, %ld)\n", mesh.index, chunk->p.x, chunk->p.y, chunk->p.z);
@@ -237,21 +339,22 @@ void AddChunkToRenderPool(ChunkPool* pool, Chunk* chunk) {
 
 void AddChunkToSimPool(ChunkPool* pool, Chunk* chunk) {
     assert(!chunk->active);
-    assert(!chunk->prevActive);
-    assert(!chunk->nextActive);
     //assert(chunk->simPropagationCount);
     chunk->active = true;
 
-    chunk->nextActive = pool->firstSimChunk;
-    if (chunk->nextActive) {
-        chunk->nextActive->prevActive = chunk;
-    }
-
-    pool->firstSimChunk = chunk;
+    chunk->simRecordIndex = (u32)pool->simChunks.count;
+    auto record = FlatArrayPush(&pool->simChunks);
+    record->p = chunk->p;
+    record->flags = 0;
+    record->chunk = chunk;
+    record->lastUseTick = GetPlatform()->tickCount;
+    ChunkRingsInsert(&pool->simRings, pool->playerRegion.origin, &pool->simChunks, chunk->simRecordIndex);
     pool->simChunkCount++;
+    assert(pool->simChunks.count == pool->simChunkCount);
 
     ForEach(&chunk->entityStorage, [&](Entity* it) {
         RegisterEntity(pool->world, it);
+        it->active = true;
     });
 }
 
@@ -270,68 +373,238 @@ void SwapChunkMeshes(Chunk* chunk) {
 }
 
 void ScheduleSimChunkEviction(ChunkPool* pool, Chunk* chunk) {
-    chunk->nextInEvictionList = pool->simChunkEvictList;
-    pool->simChunkEvictList = chunk;
+    auto slot = FlatArrayPush(&pool->simChunksToEvict);
+    *slot = chunk;
+}
+
+// NOTE: Settled chunk has nothing to do in the update until it's woken
+bool IsChunkSettled(ChunkPool* pool, ChunkSimRecord* record) {
+    bool result = false;
+    auto chunk = record->chunk;
+    if (!(record->flags & ChunkSimRecordFlag_Evict) && !chunk->locked && !chunk->saving && !chunk->blocks.retired && chunk->filled &&
+        (chunk->state == ChunkState::Complete) && !chunk->shouldBeRemeshedAfterEdit) {
+        if (chunk->visible) {
+            result = chunk->primaryMeshValid;
+        } else {
+            // NOTE: Otherwise it's going to be saved or evicted
+            result = chunk->simPropagationCount || IsInside(pool->playerRegion.min, pool->playerRegion.max, chunk->p);
+        }
+    }
+    return result;
 }
 
-void UpdateChunks(ChunkPool* pool) {
+struct ChunkScheduleView {
+    v3 origin;
+    v3 axis;
+    v3 apex;
+    f32 cosHalfAngle;
+    f32 outOfViewPenalty;
+};
+
+ChunkScheduleView MakeChunkScheduleView(SimRegion* region, Camera* camera) {
+    ChunkScheduleView view;
+    // NOTE: Chunk units. Origin is the center of the chunk the region is centered at
+    view.origin = V3(region->origin) + V3(0.5f);
+    view.axis = Normalize(camera->front);
+    // NOTE: Cone which encloses the view frustum. Its apex is moved back along the axis,
+    // so testing chunk centers is conservative for the whole chunk (bounding sphere radius)
+    f32 tanHalfFov = Tan(ToRad(camera->fovDeg / 2.0f));
+    f32 tanHalfAngle = tanHalfFov * Sqrt(1.0f + camera->aspectRatio * camera->aspectRatio);
+    f32 secHalfAngle = Sqrt(1.0f + tanHalfAngle * tanHalfAngle);
+    view.cosHalfAngle = 1.0f / secHalfAngle;
+    f32 chunkRadius = Sqrt(3.0f) * 0.5f;
+    f32 sinHalfAngle = tanHalfAngle / secHalfAngle;
+    view.apex = view.origin - view.axis * (chunkRadius / sinHalfAngle);
+    view.outOfViewPenalty = (f32)region->span;
+    return view;
+}
+
+// NOTE: Lower is sooner. Distance to region origin in chunks, chunks outside of the view
+// cone are pushed back by the region span
+f32 GetChunkSchedulePriority(ChunkScheduleView* view, Chunk* chunk) {
+    v3 center = V3(chunk->p) + V3(0.5f);
+    f32 priority = Length(center - view->origin);
+    v3 fromApex = center - view->apex;
+    if (Dot(fromApex, view->axis) < Length(fromApex) * view->cosHalfAngle) {
+        priority += view->outOfViewPenalty;
+    }
+    return priority;
+}
+
+void ChunkScheduleQueuePush(ChunkScheduleQueue* queue, Chunk* chunk, f32 priority) {
+    assert(queue->count < queue->capacity);
+    chunk->schedulePriority = priority;
+    auto entries = queue->entries;
+    u32 index = queue->count++;
+    while (index) {
+        u32 parent = (index - 1) / 2;
+        if (entries[parent].priority <= priority) break;
+        entries[index] = entries[parent];
+        index = parent;
+    }
+    entries[index] = ChunkScheduleEntry { priority, chunk };
+}
+
+Chunk* ChunkScheduleQueuePop(ChunkScheduleQueue* queue) {
+    Chunk* result = nullptr;
+    if (queue->count) {
+        auto entries = queue->entries;
+        result = entries[0].chunk;
+        auto last = entries[--queue->count];
+        u32 index = 0;
+        while (true) {
+            u32 child = index * 2 + 1;
+            if (child >= queue->count) break;
+            if ((child + 1 < queue->count) && (entries[child + 1].priority < entries[child].priority)) {
+                child++;
+            }
+            if (last.priority <= entries[child].priority) break;
+            entries[index] = entries[child];
+            index = child;
+        }
+        entries[index] = last;
+    }
+    return result;
+}
+
+// NOTE: Returns true if work was pushed for the chunk
+bool ScheduleQueuedChunk(ChunkPool* pool, Chunk* chunk) {
+    bool scheduled = false;
+    // NOTE: Chunk might have changed after it was queued (i.e. lost its mesh to an edit remesh)
+    if ((!chunk->locked) && (chunk->state == ChunkState::Complete)) {
+        if (!chunk->filled) {
+            if (TryLoadChunk(chunk)) {
+                chunk->filled = true;
+                chunk->lastModificationTick = true;
+                chunk->shouldBeRemeshedAfterEdit = false;
+                chunk->state = ChunkState::Complete;
+                chunk->locked = false;
+                TryLoadEntities(chunk);
+                UpdateNeighborMeshBorders(chunk);
+            } else {
+                chunk->locked = true;
+                if (ScheduleChunkFill(&pool->worldGen, chunk)) {
+                    scheduled = true;
+                } else {
+                    chunk->locked = false;
+                }
+            }
+        } else if (chunk->visible && !chunk->primaryMeshValid && !chunk->shouldBeRemeshedAfterEdit) {
+            chunk->locked = true;
+            if (ScheduleChunkMeshing(pool->world, chunk)) {
+                scheduled = true;
+            } else {
+                chunk->locked = false;
+            }
+        }
+    }
+    return scheduled;
+}
+
+// NOTE: Streaming jobs of chunks which left the player region are not worth finishing.
+// Cancelled jobs bail out as soon as they are picked up and the chunk gets unlocked,
+// so it can be evicted. Edit remeshes are never cancelled
+void CancelChunkJobsIfOutsideRegion(ChunkPool* pool, Chunk* chunk) {
+    assert(chunk->locked);
+    if (!IsInside(pool->playerRegion.min, pool->playerRegion.max, chunk->p)) {
+        CancelChunkJobs(chunk);
+    }
+}
+
+void UpdateChunks(ChunkPool* pool, Camera* camera) {
     timed_scope();
-    Chunk* chunk = pool->firstSimChunk;
-    // TODO: Maybe cache chunks that are not filled or smth and update them in a separate loop.
-    // Then we don't need to loop over all active chunks each frame, but only over visible ones
-    while (chunk) {
-        if ((!chunk->locked) && (!chunk->visible) && (chunk->simPropagationCount == 0)) {
+    auto scheduleQueue = &pool->scheduleQueue;
+    scheduleQueue->count = 0;
+    // NOTE: Sim pool might go over its size while pinned chunks are being evicted
+    if (scheduleQueue->capacity < pool->simChunkCount) {
+        PlatformFree(scheduleQueue->entries, nullptr);
+        scheduleQueue->capacity = pool->simChunkCount * 2;
+        scheduleQueue->entries = (ChunkScheduleEntry*)PlatformAlloc(sizeof(ChunkScheduleEntry) * scheduleQueue->capacity, 0, nullptr);
+    }
+    auto view = MakeChunkScheduleView(&pool->playerRegion, camera);
+    u32 chunkJobsInFlight = 0;
+
+    // NOTE: Records are not added or removed during the walk. Evicted chunks are removed after it
+    for (usize recordIndex = 0; recordIndex < pool->simChunks.count; recordIndex++) {
+        auto record = FlatArrayAtUnchecked(&pool->simChunks, recordIndex);
+        if (record->flags & ChunkSimRecordFlag_Settled) {
+            continue;
+        }
+        auto chunk = record->chunk;
+        if (chunk->blocks.retired && (!chunk->locked) && (!chunk->saving)) {
+            FreeRetiredChunkBlockIndices(chunk);
+        }
+        bool evicting = record->flags & ChunkSimRecordFlag_Evict;
+        if ((!chunk->locked) && (!chunk->visible) && ((chunk->simPropagationCount == 0) || evicting)) {
             // This chunk is not rendered, not simulated and lot locked
             if (!IsInside(pool->playerRegion.min, pool->playerRegion.max, chunk->p)) {
                 auto saving = chunk->saving;
+                if (!saving && evicting) {
+                    // NOTE: Stopping entities of the chunk which is evicted over the budget. If any of them was still running
+                    // the chunk is saved again, so nothing is freed while it might be in pending entity changes
+                    bool stopped = false;
+                    ForEach(&chunk->entityStorage, [&](Entity* it) {
+                        if (it->active) {
+                            it->active = false;
+                            stopped = true;
+                        }
+                    });
+                    if (stopped) {
+                        chunk->lastModificationTick = GetPlatform()->tickCount;
+                    }
+                }
                 if (!saving) {
                     // And if it is outside of a region
                     if (chunk->lastSaveTick < chunk->lastModificationTick) {
+                        ShrinkChunkBlocks(chunk);
                         chunk->saving = true;
-                        AtomicIncrement(&pool->pendingSavesCount);
                         WriteFence();
-                        if (!PlatformPushWork(PlatformHighPriorityQueue, ChunkSaveWork, chunk, pool, nullptr)) {
+                        if (!PlatformPushWorkWithCounter(PlatformHighPriorityQueue, &pool->saveWorkCounter, ChunkSaveWork, chunk, nullptr, nullptr)) {
                             chunk->saving = false;
-                            AtomicDecrement(&pool->pendingSavesCount);
                         } else {
                             log_print("Starting a save work for chunk (%ld, %ld, %ld)\n", chunk->p.x, chunk->p.y, chunk->p.z);
                         }
-                    } else {
+                    } else if (!IsChunkNextToSimulatedChunk(pool, chunk)) {
                         ScheduleSimChunkEviction(pool, chunk);
                     }
                 }
             }
         } else if (!chunk->filled) {
             if (chunk->state == ChunkState::Complete) {
-                if (TryLoadChunk(chunk)) {
-                    chunk->filled = true;
-                    chunk->lastModificationTick = true;
-                    chunk->shouldBeRemeshedAfterEdit = false;
-                    chunk->state = ChunkState::Complete;
-                    chunk->locked = false;
-                    TryLoadEntities(chunk);
-                } else {
-                    chunk->locked = true;
-                    if (!ScheduleChunkFill(&pool->worldGen, chunk)) {
-                        chunk->locked = false;
-                    }
+                if (!chunk->locked) {
+                    ChunkScheduleQueuePush(scheduleQueue, chunk, GetChunkSchedulePriority(&view, chunk));
                 }
             } else if (chunk->state == ChunkState::Filled) {
                 chunk->filled = true;
                 chunk->shouldBeRemeshedAfterEdit = false;
                 chunk->state = ChunkState::Complete;
                 chunk->locked = false;
+                UpdateNeighborMeshBorders(chunk);
             } else if (chunk->state == ChunkState::Filling) {
+                CancelChunkJobsIfOutsideRegion(pool, chunk);
+                chunkJobsInFlight++;
+            } else if (chunk->state == ChunkState::Cancelled) {
+                chunk->state = ChunkState::Complete;
+                chunk->locked = false;
             } else {
-                unreachable();
+                // NOTE: Meshing was chained after the fill. Chunk stays locked until meshing is finished
+                assert(chunk->visible);
+                assert(chunk->locked);
+                chunk->filled = true;
+                // NOTE: Borders were snapshotted when the fill was scheduled
+                chunk->shouldBeRemeshedAfterEdit = chunk->meshBordersChanged;
+                chunk->meshBordersChanged = false;
+                UpdateNeighborMeshBorders(chunk);
             }
-        } else if (chunk->visible) {
+        }
+        // NOTE: Not an else branch, so a chunk which was just filled starts meshing
+        // or finishes chained meshing in the same update
+        if (chunk->filled && chunk->visible) {
             switch (chunk->state) {
             case ChunkState::Complete: {
                 // TODO BeginMeshTask (invalidate mesh) and EndMeshTask
                 if (chunk->shouldBeRemeshedAfterEdit) {
                     //log_print("[Sim pool] Begining remesing edited chunk\n");
-                    assert(chunk->priority == ChunkPriority::Low);
                     if (pool->renderedChunkCount == pool->maxRenderedChunkCount) {
                         MakeRoomForChunkInRenderPool(pool);
                     }
@@ -346,7 +619,7 @@ void UpdateChunks(ChunkPool* pool) {
                         chunk->remeshingAfterEdit = true;
 
                         SwapChunkMeshes(chunk);
-                        chunk->priority = ChunkPriority::High;
+                        UpdateChunkRenderRecord(pool, chunk);
 
                         chunk->shouldBeRemeshedAfterEdit = false;
 
@@ -354,7 +627,7 @@ void UpdateChunks(ChunkPool* pool) {
 
                         if (!ScheduleChunkMeshing(pool->world, chunk)) {
                             SwapChunkMeshes(chunk);
-                            chunk->priority = ChunkPriority::Low;
+                            UpdateChunkRenderRecord(pool, chunk);
                             chunk->remeshingAfterEdit = false;
 
                             chunk->shouldBeRemeshedAfterEdit = true;
@@ -367,18 +640,13 @@ void UpdateChunks(ChunkPool* pool) {
                             ReturnChunkMeshToPool(pool, mesh.index);
                         }
                     }
-                } else if (!chunk->primaryMeshValid) {
-                    chunk->locked = true;
-                    if (!ScheduleChunkMeshing(pool->world, chunk)) {
-                        chunk->locked = false;
-                    }
+                } else if (!chunk->primaryMeshValid && !chunk->locked) {
+                    ChunkScheduleQueuePush(scheduleQueue, chunk, GetChunkSchedulePriority(&view, chunk));
                 }
             } break;
             case ChunkState::MeshingFinished: {
                 if (chunk->remeshingAfterEdit) {
                     //log_print("[Sim pool] End remesing edited chunk\n");
-                    assert(chunk->priority == ChunkPriority::High);
-                    chunk->priority = ChunkPriority::Low;
                     chunk->remeshingAfterEdit = false;
 
                     //SwapChunkMeshes(chunk);
@@ -388,6 +656,7 @@ void UpdateChunks(ChunkPool* pool) {
                     chunk->secondaryMeshValid = false;
                 }
                 chunk->primaryMeshValid = true;
+                UpdateChunkRenderRecord(pool, chunk);
                 chunk->state = ChunkState::Complete;
                 chunk->locked = false;
                 ValidateChunkMeshPool(pool);
@@ -409,20 +678,40 @@ void UpdateChunks(ChunkPool* pool) {
                 CompleteChunkMeshUpload(chunk);
             } break;
             case ChunkState::Filling: {} break;
-            case ChunkState::Meshing: {} break;
+            case ChunkState::Meshing: {
+                if (!chunk->remeshingAfterEdit) {
+                    CancelChunkJobsIfOutsideRegion(pool, chunk);
+                    chunkJobsInFlight++;
+                }
+            } break;
+            case ChunkState::Cancelled: {
+                assert(!chunk->remeshingAfterEdit);
+                chunk->state = ChunkState::Complete;
+                chunk->locked = false;
+            } break;
             case ChunkState::UploadingMesh: {} break;
                 invalid_default();
             }
         }
-        chunk = chunk->nextActive;
+        if (IsChunkSettled(pool, record)) {
+            record->flags |= ChunkSimRecordFlag_Settled;
+        }
     }
 
-    auto chunkToEvict = pool->simChunkEvictList;
-    while (chunkToEvict) {
-        RemoveChunkFromSimPool(pool, chunkToEvict);
-        chunkToEvict = chunkToEvict->nextInEvictionList;
+    // NOTE: Nearest chunks in view go first. Work is pushed in priority order and thieves
+    // take the oldest entries of the main thread deque, so it is picked up in the same order
+    while (chunkJobsInFlight < ChunkPool::MaxChunkJobsInFlight) {
+        auto queued = ChunkScheduleQueuePop(scheduleQueue);
+        if (!queued) break;
+        if (ScheduleQueuedChunk(pool, queued)) {
+            chunkJobsInFlight++;
+        }
     }
-    pool->simChunkEvictList = nullptr;
+
+    ForEach(&pool->simChunksToEvict, [&](Chunk** it) {
+        RemoveChunkFromSimPool(pool, *it);
+    });
+    FlatArrayClear(&pool->simChunksToEvict);
 }
 
 void InitChunkPool(ChunkPool* pool, GameWorld* world, ChunkMesher* mesher, u32 newSpan, u32 seed) {
@@ -438,17 +727,53 @@ void InitChunkPool(ChunkPool* pool, GameWorld* world, ChunkMesher* mesher, u32 n
     u32 regionSide = newSpan * 2 + 1;
     u32 regionHeight = GameWorld::MaxHeightChunk - GameWorld::MinHeightChunk + 1;
     pool->maxRenderedChunkCount = regionSide * regionSide * regionHeight + 16; // TODO: Formalize the number of extra chunks
-    pool->maxSimChunkCount = regionSide * regionSide * regionHeight + 32; // TODO: Formalize the number of extra chunks
     pool->chunkMeshPool = (ChunkMesh*)PlatformAlloc(sizeof(ChunkMesh) * pool->maxRenderedChunkCount, 0, nullptr);
-    pool->chunkMeshPoolUsage = (byte*)PlatformAlloc(sizeof(byte) * pool->maxRenderedChunkCount, 0, nullptr);
     ClearArray(pool->chunkMeshPool, pool->maxRenderedChunkCount);
-    ClearArray(pool->chunkMeshPoolUsage, pool->maxRenderedChunkCount);
+    pool->chunkMeshPoolMaskWordCount = (pool->maxRenderedChunkCount + 63) / 64;
+    pool->chunkMeshPoolFreeMask = (u64*)PlatformAlloc(sizeof(u64) * pool->chunkMeshPoolMaskWordCount, 0, nullptr);
+    for (u32x i = 0; i < pool->chunkMeshPoolMaskWordCount; i++) {
+        auto remaining = pool->maxRenderedChunkCount - i * 64;
+        pool->chunkMeshPoolFreeMask[i] = remaining >= 64 ? ~0ull : ((1ull << remaining) - 1);
+    }
+    pool->chunkMeshPoolFirstFreeWord = 0;
     pool->chunkMeshPoolFree = pool->maxRenderedChunkCount;
+    SetChunkPoolSimMemoryBudget(pool, ChunkPool::DefaultSimMemoryBudget);
+    pool->scheduleQueue.capacity = pool->maxSimChunkCount;
+    pool->scheduleQueue.entries = (ChunkScheduleEntry*)PlatformAlloc(sizeof(ChunkScheduleEntry) * pool->scheduleQueue.capacity, 0, nullptr);
+    pool->scheduleQueue.count = 0;
+    auto allocator = MakeAllocator(PlatformAlloc, PlatformFree, nullptr);
+    FlatArrayInit(&pool->renderedChunks, allocator, pool->maxRenderedChunkCount);
+    FlatArrayInit(&pool->simChunks, allocator, pool->maxSimChunkCount);
+    FlatArrayInit(&pool->simChunksToEvict, allocator, 64);
+    // NOTE: Chunks left behind are up to another region width away until they are evicted
+    InitChunkRings(&pool->renderRings, newSpan * 2 + 2);
+    InitChunkRings(&pool->simRings, newSpan * 2 + 2);
     for (u32x i = 0; i < pool->maxRenderedChunkCount; i++) {
         pool->chunkMeshPool[i].mesher = pool->mesher;
     }
 }
 
+void SetChunkPoolSimMemoryBudget(ChunkPool* pool, uptr budget) {
+    auto span = pool->playerRegion.span;
+    u32 regionSide = span * 2 + 1;
+    u32 regionHeight = GameWorld::MaxHeightChunk - GameWorld::MinHeightChunk + 1;
+    // NOTE: Whole region has to fit anyway
+    u32 minCount = regionSide * regionSide * regionHeight + 32;
+    pool->simMemoryBudget = budget;
+    pool->maxSimChunkCount = Max(minCount, (u32)(budget / ChunkPool::SimChunkMemoryEstimate));
+    log_print("[Sim pool]: Memory budget is %lu MB, pool size is %lu chunks\n", (u32)(budget / (1024 * 1024)), pool->maxSimChunkCount);
+}
+
+void RemeshVisibleChunks(ChunkPool* pool) {
+    ForEach(&pool->renderedChunks, [&](ChunkRenderRecord* it) {
+        auto chunk = it->chunk;
+        if (chunk->filled && chunk->primaryMeshValid) {
+            chunk->shouldBeRemeshedAfterEdit = true;
+            WakeChunk(chunk);
+        }
+    });
+}
+
 void MoveRegion(SimRegion* region, iv3 newP) {
     auto pool = region->pool;
 
@@ -457,6 +782,15 @@ void MoveRegion(SimRegion* region, iv3 newP) {
     iv3 newMax = newP + IV3(region->span);
     newMax.y = GameWorld::MaxHeightChunk;
 
+    if (newP != region->origin) {
+        // NOTE: Chunks which became outside of the region should be evicted
+        ForEach(&pool->simChunks, [&](ChunkSimRecord* it) {
+            it->flags &= ~ChunkSimRecordFlag_Settled;
+        });
+        ChunkRingsRebuild(&pool->simRings, newP, &pool->simChunks);
+        ChunkRingsRebuild(&pool->renderRings, newP, &pool->renderedChunks);
+    }
+
     region->origin = newP;
     region->min = newMin;
     region->max = newMax;
@@ -471,12 +805,20 @@ void MoveRegion(SimRegion* region, iv3 newP) {
                 }
 
                 if (!chunk->active) {
-                    assert(pool->simChunkCount <= pool->maxSimChunkCount);
-                    if ((pool->simChunkCount == pool->maxSimChunkCount)) {
+                    if (pool->simChunkCount >= pool->maxSimChunkCount) {
                         MakeRoomForChunkInSimPool(pool);
                     }
-                    assert(pool->simChunkCount < pool->maxSimChunkCount);
                     AddChunkToSimPool(pool, chunk);
+                } else {
+                    auto record = FlatArrayAtUnchecked(&pool->simChunks, chunk->simRecordIndex);
+                    record->lastUseTick = GetPlatform()->tickCount;
+                    if (record->flags & ChunkSimRecordFlag_Evict) {
+                        // NOTE: Region came back before the chunk was evicted
+                        record->flags &= ~(ChunkSimRecordFlag_Evict | ChunkSimRecordFlag_Settled);
+                        ForEach(&chunk->entityStorage, [&](Entity* it) {
+                            it->active = true;
+                        });
+                    }
                 }
 
                 if (!chunk->visible) {
@@ -496,34 +838,28 @@ void MoveRegion(SimRegion* region, iv3 newP) {
 
 void DrawChunks(ChunkPool* pool, RenderGroup* renderGroup, Camera* camera) {
     timed_scope();
-    auto chunk = pool->firstRenderedChunk;
-    Push(renderGroup, &RenderCommandBeginChunkBatch{});
-    while (chunk) {
-        auto state = chunk->state;
-        ChunkMesh* mesh = nullptr;
-        if (chunk->primaryMeshValid) {
-            mesh = chunk->primaryMesh;
-        } else if (chunk->secondaryMeshValid) {
-            mesh = chunk->secondaryMesh;
-        }
-
-        if (mesh) {
+    RenderCommandBeginChunkBatch beginBatchCommand {};
+    Push(renderGroup, &beginBatchCommand);
+    ForEach(&pool->renderedChunks, [&](ChunkRenderRecord* record) {
+        if (record->meshIndex != ChunkRenderRecord::NoMesh) {
+            auto mesh = pool->chunkMeshPool + record->meshIndex;
             if (mesh->vertexCount) {
-                assert(chunk->primaryMesh);
                 RenderCommandPushChunk chunkCommand = {};
                 chunkCommand.mesh = mesh;
-                chunkCommand.offset = WorldPos::Relative(camera->targetWorldPosition, WorldPos::Make(chunk->p * (i32)Chunk::Size));
+                chunkCommand.offset = WorldPos::Relative(camera->targetWorldPosition, WorldPos::Make(record->p * (i32)Chunk::Size));
                 Push(renderGroup, &chunkCommand);
             }
         }
-        chunk = chunk->nextRendered;
-    }
-    Push(renderGroup, &RenderCommandEndChunkBatch{});
+    });
+    RenderCommandEndChunkBatch endBatchCommand {};
+    Push(renderGroup, &endBatchCommand);
 }
 
 void UpdateChunkEntities(ChunkPool* pool, RenderGroup* renderGroup, Camera* camera) {
     timed_scope();
-    ForEachEntity(pool, [&](Entity* it) {
+    // NOTE: Walking the pools type by type instead of sim chunk entity lists, so the update
+    // goes over contiguous memory and runs the same behavior for a while
+    ForEachActiveEntity(pool->world, [&](Entity* it) {
         auto info = GetEntityInfo(it->type);
         if (info->Behavior) {
             it->generation = GetPlatform()->tickCount;
@@ -550,18 +886,14 @@ void UpdateChunkEntities(ChunkPool* pool, RenderGroup* renderGroup, Camera* came
 
 template <typename F>
 void ForEachEntity(ChunkPool* pool, F func) {
-    auto chunk = pool->firstSimChunk;
-    while (chunk) {
-        ForEach(&chunk->entityStorage, func);
-        chunk = chunk->nextActive;
-    }
+    ForEach(&pool->simChunks, [&](ChunkSimRecord* it) {
+        ForEach(&it->chunk->entityStorage, func);
+    });
 }
 
 template <typename F>
 void ForEachSimChunk(ChunkPool* pool, F func) {
-    auto chunk = pool->firstSimChunk;
-    while (chunk) {
-        func(chunk);
-        chunk = chunk->nextActive;
-    }
+    ForEach(&pool->simChunks, [&](ChunkSimRecord* it) {
+        func(it->chunk);
+    });
 }
@@ -14,7 +14,69 @@ struct SimRegion {
 
 void MoveRegion(SimRegion* region, iv3 newP);
 
+// NOTE: Hot part of a chunk in the pool sets. Sets are dense arrays of these and removal swaps the last record in,
+// so walking a set reads a few KB instead of chasing pointers through chunk headers
+enum ChunkSimRecordFlag : u32 {
+    // NOTE: Chunk had nothing to do on the last update. Update skips it without touching the chunk
+    // until something wakes it
+    ChunkSimRecordFlag_Settled = (1 << 0),
+    // NOTE: Chunk is pinned by sim propagating entities, but the pool is over its budget. It's saved
+    // and evicted anyway unless the region comes back to it first
+    ChunkSimRecordFlag_Evict = (1 << 1),
+};
+
+struct ChunkSimRecord {
+    iv3 p;
+    u32 flags;
+    Chunk* chunk;
+    u32 ring;
+    u32 ringSlot;
+    // NOTE: Last region move which had the chunk inside
+    u64 lastUseTick;
+};
+
+struct ChunkRenderRecord {
+    static const u32 NoMesh = 0xffffffff;
+
+    iv3 p;
+    // NOTE: Index of the drawn mesh in the mesh pool
+    u32 meshIndex;
+    Chunk* chunk;
+    u32 ring;
+    u32 ringSlot;
+};
+
+// NOTE: Records of a pool set bucketed by horizontal Chebyshev distance from the region origin (region spans
+// whole world height). Eviction goes from the outermost ring inwards and stops at the first fitting chunk
+// instead of looking at the whole set. Rings are reassigned in one pass when the origin moves.
+// Last ring holds everything further
+struct ChunkRings {
+    u32 ringCount;
+    // NOTE: Record indices
+    FlatArray<u32>* rings;
+};
+
+struct ChunkScheduleEntry {
+    f32 priority;
+    Chunk* chunk;
+};
+
+// NOTE: Binary min-heap of chunks waiting for fill or meshing. Rebuilt every update,
+// so priorities follow the region origin and the camera without extra bookkeeping
+struct ChunkScheduleQueue {
+    u32 count;
+    u32 capacity;
+    ChunkScheduleEntry* entries;
+};
+
 struct ChunkPool {
+    // NOTE: Limits streaming work pushed to the queue at once. Anything above it stays in
+    // the schedule queue and is reprioritized on the next update
+    static const u32 MaxChunkJobsInFlight = 64;
+    static const uptr DefaultSimMemoryBudget = 64 * 1024 * 1024;
+    // NOTE: Header and the widest block indices. Block entities are not counted
+    static const uptr SimChunkMemoryEstimate = sizeof(Chunk) + sizeof(ChunkBlockIndices) + Chunk::BlockCount;
+
     SimRegion playerRegion;
     GameWorld* world;
     WorldGen worldGen;
@@ -22,26 +84,41 @@ struct ChunkPool {
 
     u32 maxRenderedChunkCount;
     u32 renderedChunkCount;
-    Chunk* firstRenderedChunk;
+    FlatArray<ChunkRenderRecord> renderedChunks;
+    ChunkRings renderRings;
 
+    // NOTE: Derived from the budget. Pool goes over it only while everything outside of the region
+    // is pinned and being saved for eviction
     u32 maxSimChunkCount;
+    uptr simMemoryBudget;
     u32 simChunkCount;
-    Chunk* firstSimChunk;
+    FlatArray<ChunkSimRecord> simChunks;
+    ChunkRings simRings;
 
-    Chunk* simChunkEvictList;
-    volatile u32 pendingSavesCount;
+    FlatArray<Chunk*> simChunksToEvict;
+    // NOTE: Counts save work in flight
+    WorkCounter saveWorkCounter;
 
     u32 chunkMeshPoolFree;
-    byte* chunkMeshPoolUsage;
+    // NOTE: Bit per mesh, set while the mesh is free. Bits past the pool size are never set
+    u64* chunkMeshPoolFreeMask;
+    u32 chunkMeshPoolMaskWordCount;
+    // NOTE: Words below it have no free meshes
+    u32 chunkMeshPoolFirstFreeWord;
     ChunkMesh* chunkMeshPool;
     b32 hasPendingRemeshesAfterEdit;
+
+    ChunkScheduleQueue scheduleQueue;
 };
 
 void InitChunkPool(ChunkPool* pool, GameWorld* world, ChunkMesher* mesher, u32 newSpan, u32 seed);
+void SetChunkPoolSimMemoryBudget(ChunkPool* pool, uptr budget);
+// NOTE: Visible chunks are remeshed the same way as after an edit, keeping the old mesh until the new one is ready
+void RemeshVisibleChunks(ChunkPool* pool);
 
 void DrawChunks(ChunkPool* pool, RenderGroup* renderGroup, Camera* camera);
 void UpdateChunkEntities(ChunkPool* pool, RenderGroup* renderGroup, Camera* camera);
-void UpdateChunks(ChunkPool* region);
+void UpdateChunks(ChunkPool* region, Camera* camera);
 
 template <typename F>
 void ForEachEntity(ChunkPool* pool, F func);
@@ -11,20 +11,41 @@
 #define COMPILER_MSVC
 #elif defined(__clang__)
 #define COMPILER_CLANG
+#elif defined(__GNUC__)
+#define COMPILER_GCC
 #else
 #error Unsupported compiler
 #endif
 
 #if defined(PLATFORM_WINDOWS)
 #define debug_break() __debugbreak()
-#elif defined(PLATFORM_LINUX)
+#elif defined(PLATFORM_LINUX) && defined(COMPILER_CLANG)
 #define debug_break() __builtin_debugtrap()
+#elif defined(PLATFORM_LINUX)
+#define debug_break() __builtin_trap()
 #endif
 
-// TODO: Define these on other platforms
+#if defined(COMPILER_MSVC)
 #include <intrin.h>
 #define WriteFence() (_WriteBarrier(), _mm_sfence())
 #define ReadFence() (_ReadBarrier(), _mm_lfence())
+#define CompilerBarrier() _ReadWriteBarrier()
+#define FullFence() _mm_mfence()
+#else
+#include <x86intrin.h>
+#define WriteFence() (__atomic_signal_fence(__ATOMIC_SEQ_CST), _mm_sfence())
+#define ReadFence() (__atomic_signal_fence(__ATOMIC_SEQ_CST), _mm_lfence())
+#define CompilerBarrier() __atomic_signal_fence(__ATOMIC_SEQ_CST)
+#define FullFence() __atomic_thread_fence(__ATOMIC_SEQ_CST)
+// NOTE: Calling conventions are no-ops on x86-64
+#define __cdecl
+#define __stdcall
+// NOTE: Bounds-checked CRT functions used by the game code
+#include <wchar.h>
+#define strcpy_s(dest, size, src) snprintf((dest), (size), "%s", (src))
+#define sprintf_s snprintf
+#define swprintf_s swprintf
+#endif
 
 #define constant static inline const
 #define array_count(arr) ((uint)(sizeof(arr) / sizeof(arr[0])))
@@ -146,10 +167,10 @@ extern void* GlobalLoggerData;
 extern AssertHandlerFn* GlobalAssertHandler;
 extern void* GlobalAssertHandlerData;
 
-#define log_print(fmt, ...) _GlobalLoggerWithArgs(GlobalLoggerData, fmt, __VA_ARGS__)
-#define assert(expr, ...) do { if (!(expr)) {_GlobalAssertHandler(GlobalAssertHandlerData, __FILE__, __func__, __LINE__, #expr, __VA_ARGS__);}} while(false)
+#define log_print(fmt, ...) _GlobalLoggerWithArgs(GlobalLoggerData, fmt, ##__VA_ARGS__)
+#define assert(expr, ...) do { if (!(expr)) {_GlobalAssertHandler(GlobalAssertHandlerData, __FILE__, __func__, __LINE__, #expr, ##__VA_ARGS__);}} while(false)
 // NOTE: Defined always
-#define panic(expr, ...) do { if (!(expr)) {_GlobalAssertHandler(GlobalAssertHandlerData, __FILE__, __func__, __LINE__, #expr, __VA_ARGS__);}} while(false)
+#define panic(expr, ...) do { if (!(expr)) {_GlobalAssertHandler(GlobalAssertHandlerData, __FILE__, __func__, __LINE__, #expr, ##__VA_ARGS__);}} while(false)
 
 inline void _GlobalLoggerWithArgs(void* data, const char* fmt, ...) {
     va_list args;
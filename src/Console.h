@@ -61,7 +61,9 @@ static const ConsoleCommand GlobalConsoleCommands[] = {
     { "pos",                SetEntityPosCommand },
     { "inventory",          PrintPlayerInventoryCommand },
     { "meta_info",          PrintGameMetaInfoCommand },
-    { "creative_mode",      ToggleCreativeModeCommand }
+    { "creative_mode",      ToggleCreativeModeCommand },
+    { "sim_budget",         SimBudgetCommand, "Sim chunk pool memory budget in megabytes" },
+    { "mesher",             MesherCommand, "Available modes: naive, greedy, binary" }
 };
 
 struct ConsoleCommandRecord {
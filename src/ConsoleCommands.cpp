@@ -245,3 +245,43 @@ void ToggleCreativeModeCommand(Console* console, Context* context, ConsoleComman
         LogMessage(console->logger, "Creative mode disabled\n");
     }
 }
+
+void SimBudgetCommand(Console* console, Context* context, ConsoleCommandArgs* args) {
+    auto pool = &GetWorld()->chunkPool;
+    auto arg = PullCommandArg(args);
+    if (arg) {
+        auto value = StringToInt(arg);
+        if (value.succeed && value.value > 0) {
+            SetChunkPoolSimMemoryBudget(pool, (uptr)value.value * 1024 * 1024);
+            LogMessage(console->logger, "Sim budget set to %d MB (%lu chunks)\n", (int)value.value, pool->maxSimChunkCount);
+        } else {
+            LogMessage(console->logger, "Invalid args\n");
+        }
+    } else {
+        LogMessage(console->logger, "Sim budget is %lu MB (%lu chunks), %lu chunks in use\n", (u32)(pool->simMemoryBudget / (1024 * 1024)), pool->maxSimChunkCount, pool->simChunkCount);
+    }
+}
+
+void MesherCommand(Console* console, Context* context, ConsoleCommandArgs* args) {
+    auto mesher = &context->chunkMesher;
+    auto arg = PullCommandArg(args);
+    if (arg) {
+        bool recognized = true;
+        if (StringsAreEqual(arg, "naive")) {
+            mesher->mode = ChunkMeshMode::Naive;
+        } else if (StringsAreEqual(arg, "greedy")) {
+            mesher->mode = ChunkMeshMode::Greedy;
+        } else if (StringsAreEqual(arg, "binary")) {
+            mesher->mode = ChunkMeshMode::Binary;
+        } else {
+            recognized = false;
+            LogMessage(console->logger, "Unknown mesher mode %s\n", arg);
+        }
+        if (recognized) {
+            RemeshVisibleChunks(&GetWorld()->chunkPool);
+            LogMessage(console->logger, "Mesher mode changed to %s\n", ToString(mesher->mode));
+        }
+    } else {
+        LogMessage(console->logger, "Mesher mode is %s\n", ToString(mesher->mode));
+    }
+}
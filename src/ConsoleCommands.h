@@ -20,3 +20,5 @@ void SetEntityPosCommand(Console* console, Context* context, ConsoleCommandArgs*
 void PrintPlayerInventoryCommand(Console* console, Context* context, ConsoleCommandArgs* args);
 void PrintGameMetaInfoCommand(Console* console, Context* context, ConsoleCommandArgs* args);
 void ToggleCreativeModeCommand(Console* console, Context* context, ConsoleCommandArgs* args);
+void SimBudgetCommand(Console* console, Context* context, ConsoleCommandArgs* args);
+void MesherCommand(Console* console, Context* context, ConsoleCommandArgs* args);
@@ -2,6 +2,22 @@
 
 #include "Debug.h"
 
+void ArenaBulletText(const char* name, MemoryArena* arena) {
+    char usedBuffer[32];
+    usedBuffer[0] = 0;
+    char committedBuffer[32];
+    committedBuffer[0] = 0;
+    char peakBuffer[32];
+    peakBuffer[0] = 0;
+    char reservedBuffer[32];
+    reservedBuffer[0] = 0;
+    PrettySize(usedBuffer, 32, arena->offset);
+    PrettySize(committedBuffer, 32, arena->Commit ? arena->committed : arena->size);
+    PrettySize(peakBuffer, 32, arena->peak);
+    PrettySize(reservedBuffer, 32, arena->size);
+    ImGui::BulletText("%s: used %s, committed %s, peak %s, reserved %s", name, usedBuffer, committedBuffer, peakBuffer, reservedBuffer);
+}
+
 void ChunkToolMain(DebugUI* ui) {
     auto context = GetContext();
     auto world = GetWorld();
@@ -10,18 +26,15 @@ void ChunkToolMain(DebugUI* ui) {
     assert(player);
     iv3 min = IV3(I32::Max);
     iv3 max = IV3(I32::Min);
-    auto chunk = pool->firstSimChunk;
-    while (chunk) {
-        if (chunk->p.x < min.x) min.x = chunk->p.x;
-        if (chunk->p.y < min.y) min.y = chunk->p.y;
-        if (chunk->p.z < min.z) min.z = chunk->p.z;
+    ForEach(&pool->simChunks, [&](ChunkSimRecord* it) {
+        if (it->p.x < min.x) min.x = it->p.x;
+        if (it->p.y < min.y) min.y = it->p.y;
+        if (it->p.z < min.z) min.z = it->p.z;
 
-        if (chunk->p.x > max.x) max.x = chunk->p.x;
-        if (chunk->p.y > max.y) max.y = chunk->p.y;
-        if (chunk->p.z > max.z) max.z = chunk->p.z;
-
-        chunk = chunk->nextActive;
-    }
+        if (it->p.x > max.x) max.x = it->p.x;
+        if (it->p.y > max.y) max.y = it->p.y;
+        if (it->p.z > max.z) max.z = it->p.z;
+    });
     if (ImGui::Button("Up##chunkLayerUP")) {
         if (ui->chunkLayer < max.y) ui->chunkLayer++;
     }
@@ -37,7 +50,7 @@ void ChunkToolMain(DebugUI* ui) {
     ImGui::Text("Layer: %ld", (long)ui->chunkLayer);
     ImGui::Separator();
     ImGui::BulletText("Chunks: count %lu, sim %lu, visible %lu", (u32)world->chunkHashMap.entryCount, pool->simChunkCount, pool->renderedChunkCount);
-    ImGui::BulletText("Pool: sim size %lu, render size %lu", pool->maxSimChunkCount, pool->maxRenderedChunkCount);
+    ImGui::BulletText("Pool: sim size %lu (budget %lu MB), render size %lu", pool->maxSimChunkCount, (u32)(pool->simMemoryBudget / (1024 * 1024)), pool->maxRenderedChunkCount);
     ImGui::BulletText("Mesh pool: count %lu, free %lu", pool->maxRenderedChunkCount, pool->chunkMeshPoolFree);
     {
         char alBuffer[32];
@@ -64,6 +77,8 @@ void ChunkToolMain(DebugUI* ui) {
         PrettySize(freeBuffer, 32, pool->mesher->freeBlockCount * sizeof(ChunkMeshBlock));
         ImGui::BulletText("Mesher memory: allocated %lu (%s), used %lu (%s), free %lu (%s)", pool->mesher->totalBlockCount, totalBuffer, used, usedBuffer, pool->mesher->freeBlockCount, freeBuffer);
     }
+    ArenaBulletText("Game arena", GetContext()->gameArena);
+    ArenaBulletText("Temp arena", GetContext()->tempArena);
 
 
     ImGui::Separator();
@@ -183,7 +198,7 @@ void ChunkToolChunkInfo(DebugUI* ui) {
         ImGui::BulletText("primaryMeshValid: %s", chunk->primaryMeshValid ? "true" : "false");
         ImGui::BulletText("secondaryMeshValid: %s", chunk->secondaryMeshValid ? "true" : "false");
         ImGui::BulletText("remeshingAfterEdit: %s", chunk->remeshingAfterEdit ? "true" : "false");
-        ImGui::BulletText("priority: %s", ToString(chunk->priority));
+        ImGui::BulletText("schedulePriority: %.2f", chunk->schedulePriority);
         ImGui::BulletText("shouldBeRemeshedAfterEdit: %s", chunk->shouldBeRemeshedAfterEdit ? "true" : "false");
         ImGui::BulletText("lastModificationTick: %llu", chunk->lastModificationTick);
         ImGui::BulletText("active: %s", chunk->active ? "true" : "false");
@@ -2,8 +2,8 @@
 #include "World.h"
 
 EntityID GenEntityID(GameWorld* world, EntityKind kind) {
-    assert(world->entitySerialCount < (U64::Max - 1));
-    EntityID result = ++world->entitySerialCount;
+    world->entitySerialCount++;
+    EntityID result = EntityTableAllocate(&world->entityTable);
     return result;
 }
 
@@ -32,7 +32,7 @@ WorldPos GetEntityPosition(Entity* entity) {
 }
 
 template <typename F>
-void ForEachEntityNeighbor(GameWorld* world, iv3 p, F func) {
+void ForEachEntityNeighbor(BlockEntity* entity, F func) {
     static const iv3 Offsets[] = {
         { -1,  0,  0 },
         {  1,  0,  0 },
@@ -51,8 +51,10 @@ void ForEachEntityNeighbor(GameWorld* world, iv3 p, F func) {
         Direction::South,
     };
 
+    auto cursor = MakeBlockCursor(entity);
     for (usize i = 0; i < array_count(Offsets); i++) {
-        auto block = GetBlock(world, p + Offsets[i]);
+        SetBlockCursor(&cursor, entity->p + Offsets[i]);
+        auto block = GetBlock(&cursor);
         func(block, Directions[i]);
     }
 }
@@ -6,6 +6,7 @@
 //#include "Inventory.h"
 #include "Block.h"
 #include "BinaryBlob.h"
+#include "EntityPool.h"
 
 struct Material;
 struct GameWorld;
@@ -14,6 +15,7 @@ struct Camera;
 struct Entity;
 struct GameWorld;
 struct Block;
+struct Chunk;
 
 typedef u64 EntityID;
 
@@ -62,9 +64,14 @@ struct Entity {
     EntityType type;
     u32 flags;
     b32 deleted;
+    // NOTE: Entity lives in a sim chunk and gets updated
+    b32 active;
+    EntityHandle poolHandle;
 
     Entity* nextInStorage;
     Entity* prevInStorage;
+    // NOTE: Chunk whose storage holds the entity
+    Chunk* chunk;
 
     GameWorld* world;
 };
@@ -158,4 +165,4 @@ typedef void(EntityProcessOverlapFn)(GameWorld* world, SpatialEntity* testEntity
 typedef void(EntityUpdateAndRenderUIFn)(Entity* entity, EntityUIInvoke reason);
 
 template <typename F>
-void ForEachEntityNeighbor(GameWorld* world, iv3 p, F func);
+void ForEachEntityNeighbor(BlockEntity* entity, F func);
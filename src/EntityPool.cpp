@@ -0,0 +1,113 @@
+#include "EntityPool.h"
+
+void InitEntityPool(EntityPool* pool, AllocatePagesFn* pageAlloc, u32 size, u32 alignment) {
+    assert(size);
+    assert(IsPowerOfTwo(alignment));
+    pool->PageAlloc = pageAlloc;
+    pool->alignment = alignment;
+    pool->stride = (size + alignment - 1) & ~(alignment - 1);
+    // NOTE: At least a few entities in a slab even for big types
+    pool->slabSize = Max(EntityPool::SlabSize, pool->stride * 16);
+    // NOTE: Slot indices and generations go before slots
+    pool->slotsPerSlab = pool->slabSize / (pool->stride + sizeof(u32) * 2);
+    while (pool->slotsPerSlab * (pool->stride + sizeof(u32) * 2) + alignment > pool->slabSize) {
+        pool->slotsPerSlab--;
+    }
+    assert(pool->slotsPerSlab && pool->slotsPerSlab <= 0xffff);
+    pool->slabCount = 0;
+    pool->liveCount = 0;
+    pool->firstFree = EntityPool::InvalidSlot;
+}
+
+inline u32 MakeEntityPoolIndex(u32 slab, u32 slot) {
+    return (slab << 16) | slot;
+}
+
+inline Entity* GetEntityPoolSlot(EntityPool* pool, EntityPoolSlab* slab, u32 slot) {
+    return (Entity*)(slab->slots + (uptr)slot * pool->stride);
+}
+
+bool AddEntityPoolSlab(EntityPool* pool) {
+    bool result = false;
+    if (pool->slabCount < EntityPool::MaxSlabCount) {
+        auto memory = (byte*)pool->PageAlloc(pool->slabSize);
+        if (memory) {
+            auto slabIndex = pool->slabCount++;
+            auto slab = pool->slabs + slabIndex;
+            auto count = pool->slotsPerSlab;
+            slab->generations = (u32*)memory;
+            slab->nextFree = slab->generations + count;
+            auto slots = (uptr)(slab->nextFree + count);
+            slab->slots = (byte*)((slots + pool->alignment - 1) & ~((uptr)pool->alignment - 1));
+            // NOTE: Pages are zeroed, so all generations are even (free). Chaining slots in order,
+            // so entities are allocated contiguously
+            for (u32 i = 0; i < count; i++) {
+                slab->nextFree[i] = (i + 1 < count) ? MakeEntityPoolIndex(slabIndex, i + 1) : pool->firstFree;
+            }
+            pool->firstFree = MakeEntityPoolIndex(slabIndex, 0);
+            result = true;
+        }
+    }
+    return result;
+}
+
+Entity* EntityPoolAllocate(EntityPool* pool, EntityHandle* handle) {
+    Entity* result = nullptr;
+    if (pool->firstFree == EntityPool::InvalidSlot) {
+        AddEntityPoolSlab(pool);
+    }
+    if (pool->firstFree != EntityPool::InvalidSlot) {
+        auto index = pool->firstFree;
+        auto slab = pool->slabs + (index >> 16);
+        auto slot = index & 0xffff;
+        pool->firstFree = slab->nextFree[slot];
+        assert(!(slab->generations[slot] & 1));
+        slab->generations[slot]++;
+        pool->liveCount++;
+        result = GetEntityPoolSlot(pool, slab, slot);
+        memset(result, 0, pool->stride);
+        handle->index = index;
+        handle->generation = slab->generations[slot];
+    } else {
+        log_print("[Entity pool] Out of memory\n");
+    }
+    return result;
+}
+
+void EntityPoolFree(EntityPool* pool, EntityHandle handle) {
+    auto slabIndex = handle.index >> 16;
+    auto slot = handle.index & 0xffff;
+    assert(slabIndex < pool->slabCount);
+    auto slab = pool->slabs + slabIndex;
+    assert(slab->generations[slot] == handle.generation);
+    slab->generations[slot]++;
+    slab->nextFree[slot] = pool->firstFree;
+    pool->firstFree = handle.index;
+    assert(pool->liveCount);
+    pool->liveCount--;
+}
+
+Entity* EntityPoolGet(EntityPool* pool, EntityHandle handle) {
+    Entity* result = nullptr;
+    auto slabIndex = handle.index >> 16;
+    auto slot = handle.index & 0xffff;
+    if (slabIndex < pool->slabCount && slot < pool->slotsPerSlab) {
+        auto slab = pool->slabs + slabIndex;
+        if (handle.generation && slab->generations[slot] == handle.generation) {
+            result = GetEntityPoolSlot(pool, slab, slot);
+        }
+    }
+    return result;
+}
+
+template <typename F>
+void ForEach(EntityPool* pool, F func) {
+    for (u32 slabIndex = 0; slabIndex < pool->slabCount; slabIndex++) {
+        auto slab = pool->slabs + slabIndex;
+        for (u32 slot = 0; slot < pool->slotsPerSlab; slot++) {
+            if (slab->generations[slot] & 1) {
+                func(GetEntityPoolSlot(pool, slab, slot));
+            }
+        }
+    }
+}
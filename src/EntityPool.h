@@ -0,0 +1,52 @@
+#pragma once
+
+#include "Common.h"
+#include "Platform.h"
+
+struct Entity;
+
+// NOTE: Entities of one type live in slabs of equally sized slots, so walking a type touches
+// contiguous memory and creating or destroying entities doesn't go to the system allocator.
+// Every slot has a generation which is odd while the slot is live. Handle is valid while
+// its generation matches the slot, so stale handles to reused slots are detected
+struct EntityHandle {
+    // NOTE: Slab index in high 16 bits, slot in low 16 bits
+    u32 index;
+    // NOTE: Zero is never a live generation, so zeroed handle is null
+    u32 generation;
+};
+
+inline bool IsNull(EntityHandle handle) { return handle.generation == 0; }
+
+struct EntityPoolSlab {
+    u32* generations;
+    u32* nextFree;
+    byte* slots;
+};
+
+struct EntityPool {
+    constant u32 SlabSize = 64 * 1024;
+    constant u32 MaxSlabCount = 1024;
+    constant u32 InvalidSlot = 0xffffffff;
+
+    AllocatePagesFn* PageAlloc;
+    u32 stride;
+    u32 alignment;
+    u32 slotsPerSlab;
+    u32 slabSize;
+    u32 slabCount;
+    u32 liveCount;
+    u32 firstFree;
+    EntityPoolSlab slabs[MaxSlabCount];
+};
+
+void InitEntityPool(EntityPool* pool, AllocatePagesFn* pageAlloc, u32 size, u32 alignment);
+// NOTE: Returns zeroed memory of the slot
+Entity* EntityPoolAllocate(EntityPool* pool, EntityHandle* handle);
+void EntityPoolFree(EntityPool* pool, EntityHandle handle);
+// NOTE: Returns null if the handle is stale
+Entity* EntityPoolGet(EntityPool* pool, EntityHandle handle);
+
+// NOTE: Visits live entities in memory order. Entities allocated during the walk might be visited too
+template <typename F>
+void ForEach(EntityPool* pool, F func);
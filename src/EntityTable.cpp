@@ -0,0 +1,146 @@
+#include "EntityTable.h"
+
+void InitEntityTable(EntityTable* table, MemoryArena* arena) {
+    table->arena = arena;
+    table->slots = (EntityTableSlot*)arena->begin;
+    table->slotCount = 0;
+    table->usedCount = 0;
+    table->firstFree = EntityTable::InvalidSlot;
+    // NOTE: Reserving slot 0 for null id
+    PushSize(arena, sizeof(EntityTableSlot), MemoryArenaFlag_None, alignof(EntityTableSlot));
+    auto nullSlot = table->slots + table->slotCount++;
+    nullSlot->entity = nullptr;
+    nullSlot->generation = 0;
+    nullSlot->nextFree = EntityTable::SlotUsed;
+}
+
+// NOTE: Adds slots up to newCount. New slots go to the free list, lower indices first
+void GrowEntityTable(EntityTable* table, u32 newCount) {
+    panic(newCount <= EntityTable::MaxSlotCount, "[Entity table] Too many entities");
+    assert(newCount > table->slotCount);
+    auto count = newCount - table->slotCount;
+    auto newSlots = (EntityTableSlot*)PushSize(table->arena, sizeof(EntityTableSlot) * count, MemoryArenaFlag_None, alignof(EntityTableSlot));
+    assert(newSlots == table->slots + table->slotCount);
+    for (u32 i = newCount; i > table->slotCount; i--) {
+        auto slot = table->slots + (i - 1);
+        slot->entity = nullptr;
+        slot->generation = 0;
+        slot->nextFree = table->firstFree;
+        table->firstFree = i - 1;
+    }
+    table->slotCount = newCount;
+}
+
+EntityID EntityTableAllocate(EntityTable* table) {
+    if (table->firstFree == EntityTable::InvalidSlot) {
+        GrowEntityTable(table, Min(table->slotCount + EntityTable::GrowSlotCount, EntityTable::MaxSlotCount));
+    }
+    auto index = table->firstFree;
+    auto slot = table->slots + index;
+    table->firstFree = slot->nextFree;
+    slot->nextFree = EntityTable::SlotUsed;
+    slot->entity = nullptr;
+    table->usedCount++;
+    return MakeEntityID(index, slot->generation);
+}
+
+void EntityTableFree(EntityTable* table, EntityID id) {
+    auto index = GetEntityIDSlot(id);
+    assert(index && index < table->slotCount);
+    auto slot = table->slots + index;
+    assert(slot->nextFree == EntityTable::SlotUsed);
+    assert(slot->generation == GetEntityIDGeneration(id));
+    slot->entity = nullptr;
+    slot->generation++;
+    slot->nextFree = table->firstFree;
+    table->firstFree = index;
+    assert(table->usedCount);
+    table->usedCount--;
+}
+
+bool EntityTableAcquire(EntityTable* table, EntityID id) {
+    bool result = false;
+    auto index = GetEntityIDSlot(id);
+    auto generation = GetEntityIDGeneration(id);
+    if (index && index < EntityTable::MaxSlotCount) {
+        if (index >= table->slotCount) {
+            GrowEntityTable(table, index + 1);
+        }
+        auto slot = table->slots + index;
+        if (slot->nextFree == EntityTable::SlotUsed) {
+            result = slot->generation == generation;
+        } else {
+            // NOTE: Slot is free only if the world file is older than the entity (or missing).
+            // Doesn't happen often, so just walking the free list
+            auto link = &table->firstFree;
+            while (*link != index) {
+                assert(*link != EntityTable::InvalidSlot);
+                link = &table->slots[*link].nextFree;
+            }
+            *link = slot->nextFree;
+            slot->nextFree = EntityTable::SlotUsed;
+            slot->generation = generation;
+            slot->entity = nullptr;
+            table->usedCount++;
+            result = true;
+        }
+    }
+    return result;
+}
+
+void EntityTableAcquireSerialIDs(EntityTable* table, u64 count) {
+    panic(count < EntityTable::MaxSlotCount, "[Entity table] Too many entities");
+    if (count >= table->slotCount) {
+        // NOTE: Growing at once, so every slot is found at the head of the free list
+        GrowEntityTable(table, (u32)count + 1);
+    }
+    for (u64 id = 1; id <= count; id++) {
+        auto acquired = EntityTableAcquire(table, (EntityID)id);
+        assert(acquired);
+    }
+}
+
+void EntityTableRestore(EntityTable* table, u32 slotCount, const u32* generations, const u8* used) {
+    assert(table->slotCount == 1 && !table->usedCount);
+    if (slotCount > table->slotCount) {
+        GrowEntityTable(table, slotCount);
+        // NOTE: Free list is rebuilt below
+        table->firstFree = EntityTable::InvalidSlot;
+        for (u32 i = slotCount - 1; i > 0; i--) {
+            auto slot = table->slots + i;
+            slot->generation = generations[i];
+            if (used[i]) {
+                slot->nextFree = EntityTable::SlotUsed;
+                table->usedCount++;
+            } else {
+                slot->nextFree = table->firstFree;
+                table->firstFree = i;
+            }
+        }
+    }
+}
+
+bool EntityTableSet(EntityTable* table, EntityID id, Entity* entity) {
+    bool result = false;
+    auto index = GetEntityIDSlot(id);
+    if (index && index < table->slotCount) {
+        auto slot = table->slots + index;
+        if (slot->nextFree == EntityTable::SlotUsed && slot->generation == GetEntityIDGeneration(id)) {
+            slot->entity = entity;
+            result = true;
+        }
+    }
+    return result;
+}
+
+Entity* EntityTableGet(EntityTable* table, EntityID id) {
+    Entity* result = nullptr;
+    auto index = GetEntityIDSlot(id);
+    if (index < table->slotCount) {
+        auto slot = table->slots + index;
+        if (slot->nextFree == EntityTable::SlotUsed && slot->generation == GetEntityIDGeneration(id)) {
+            result = slot->entity;
+        }
+    }
+    return result;
+}
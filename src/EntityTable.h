@@ -0,0 +1,50 @@
+#pragma once
+
+#include "Common.h"
+#include "Memory.h"
+#include "Entity.h"
+
+// NOTE: Maps entity ids to entities without hashing. Id is a slot index in the low 32 bits and
+// the slot generation in the high 32 bits, so it is still a plain u64 on disk. Slot is taken
+// for as long as the entity exists, even while its chunk is unloaded, and its generation is
+// bumped when the entity is deleted, so ids of deleted entities never resolve to a new one.
+// Slot 0 is never used, so zero id is still a null id
+struct EntityTableSlot {
+    // NOTE: Null while the entity is not registered (i.e. its chunk is not in the sim or render pool)
+    Entity* entity;
+    u32 generation;
+    // NOTE: SlotUsed for taken slots
+    u32 nextFree;
+};
+
+struct EntityTable {
+    constant u32 MaxSlotCount = 1 << 24;
+    constant u32 GrowSlotCount = 4096;
+    constant u32 InvalidSlot = 0xffffffff;
+    constant u32 SlotUsed = 0xfffffffe;
+
+    // NOTE: Reserves space for MaxSlotCount slots, so slots never move and growing is just a commit
+    MemoryArena* arena;
+    EntityTableSlot* slots;
+    u32 slotCount;
+    u32 usedCount;
+    u32 firstFree;
+};
+
+inline u32 GetEntityIDSlot(EntityID id) { return (u32)id; }
+inline u32 GetEntityIDGeneration(EntityID id) { return (u32)(id >> 32); }
+inline EntityID MakeEntityID(u32 slot, u32 generation) { return ((u64)generation << 32) | (u64)slot; }
+
+void InitEntityTable(EntityTable* table, MemoryArena* arena);
+EntityID EntityTableAllocate(EntityTable* table);
+void EntityTableFree(EntityTable* table, EntityID id);
+// NOTE: Takes the slot of an id which came from disk. Returns false if the slot is taken by another id
+bool EntityTableAcquire(EntityTable* table, EntityID id);
+// NOTE: Marks slots of ids [1, count] as taken with zero generation. Ids from worlds
+// saved before the table was introduced are serial numbers, so they are still valid
+void EntityTableAcquireSerialIDs(EntityTable* table, u64 count);
+// NOTE: Fills empty table with saved slots. Generations of free slots are kept too, so ids of deleted entities stay stale
+void EntityTableRestore(EntityTable* table, u32 slotCount, const u32* generations, const u8* used);
+// NOTE: Returns false if the id is stale
+bool EntityTableSet(EntityTable* table, EntityID id, Entity* entity);
+Entity* EntityTableGet(EntityTable* table, EntityID id);
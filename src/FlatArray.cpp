@@ -64,7 +64,7 @@ T* FlatArrayPushArray(FlatArray<T>* array, usize count) {
     if (free < count) {
         auto needed = count - free;
         auto factor = needed / array->capacity;
-        if (factor < GrowFactor) factor = GrowFactor;
+        if (factor < FlatArray<T>::GrowFactor) factor = FlatArray<T>::GrowFactor;
         array->Grow(factor);
     }
     free = array->capacity - array->count;
@@ -88,6 +88,15 @@ void FlatArrayClear(FlatArray<T>* array) {
     array->count = 0;
 }
 
+template <typename T>
+void FlatArrayUnorderedRemove(FlatArray<T>* array, usize index) {
+    assert(index < array->count);
+    array->count--;
+    if (index != array->count) {
+        array->data[index] = array->data[array->count];
+    }
+}
+
 template <typename T>
 void FlatArrayResize(FlatArray<T>* array, usize size) {
     assert(!array->count);
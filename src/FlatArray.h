@@ -40,6 +40,10 @@ T* FlatArrayEnd(FlatArray<T>* array);
 template <typename T>
 void FlatArrayClear(FlatArray<T>* array);
 
+// NOTE: Moves the last element into the removed slot. Order is not preserved
+template <typename T>
+void FlatArrayUnorderedRemove(FlatArray<T>* array, usize index);
+
 template <typename T>
 void FlatArrayResize(FlatArray<T>* array, usize size);
 
@@ -113,10 +113,8 @@ const ShaderProgramSource ShaderSources[] =
         "    return color.r * 0.2126 + color.g * 0.7152 + color.b * 0.0722;\n"
         "}\n"
         "#line 2\n"
-        "layout (location = 0) in vec3 Position;\n"
-        "layout (location = 1) in vec3 Normal;\n"
-        "layout (location = 2) in vec3 Tangent;\n"
-        "layout (location = 3) in uint VoxelValue;\n"
+        "layout (location = 0) in uint PackedVertex;\n"
+        "layout (location = 1) in uint VoxelValue;\n"
         "layout (location = 4) out VertOut {\n"
         "    flat uint voxelValue;\n"
         "    vec3 normal;\n"
@@ -130,17 +128,20 @@ const ShaderProgramSource ShaderSources[] =
         "#define TERRAIN_TEX_ARRAY_NUM_LAYERS 32\n"
         "#define INDICES_PER_CHUNK_QUAD 6\n"
         "#define VERTICES_PER_QUAD 4\n"
-        "vec2 UV[] = vec2[](vec2(0.0f, 0.0f),\n"
-        "                   vec2(1.0f, 0.0f),\n"
-        "                   vec2(1.0f, 1.0f),\n"
-        "                   vec2(0.0f, 1.0f));\n"
+        "const vec3 FaceNormals[6] = vec3[6](vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, -1.0f, 0.0f), vec3(-1.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f));\n"
+        "const vec3 FaceTangents[6] = vec3[6](vec3(1.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f), vec3(1.0f, 0.0f, 0.0f), vec3(-1.0f, 0.0f, 0.0f));\n"
         "void main()\n"
         "{\n"
-        "    int vertIndexInQuad = gl_VertexID % 4;\n"
-        "    vertOut.uv = UV[min(vertIndexInQuad, VERTICES_PER_QUAD - 1)];\n"
+        "    uvec3 corner = uvec3(PackedVertex, PackedVertex >> 6, PackedVertex >> 12) & 0x3fu;\n"
+        "    uint face = (PackedVertex >> 18) & 0x7u;\n"
+        "    vec3 Position = vec3(corner) - 0.5f;\n"
+        "    vec3 normal = FaceNormals[face];\n"
+        "    vec3 tangent = FaceTangents[face];\n"
+        "    vec3 bitangent = cross(normal, tangent);\n"
+        "    vertOut.uv = vec2(dot(Position, tangent), dot(Position, bitangent)) + 0.5f;\n"
         "    vertOut.voxelValue = VoxelValue;\n"
         "    vertOut.position = Position + Offset;\n"
-        "    vertOut.normal = Normal;\n"
+        "    vertOut.normal = normal;\n"
         "    vertOut.viewSpacePos = (FrameData.viewMatrix * vec4(vertOut.position, 1.0f)).xyz;\n"
         "    vertOut.lightSpacePos[0] = FrameData.lightSpaceMatrices[0] * vec4(vertOut.position, 1.0f);\n"
         "    vertOut.lightSpacePos[1] = FrameData.lightSpaceMatrices[1] * vec4(vertOut.position, 1.0f);\n"
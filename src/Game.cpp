@@ -267,9 +267,7 @@ void RegisterBuiltInEntities(Context* context) {
     }
 }
 
-void FluxInit(Context* context) {
-    log_print("Chunk size %llu\n", sizeof(Chunk));
-
+void FluxLoadAssets(Context* context) {
     context->hdrMap = LoadCubemapHDR("../res/desert_sky/nz.hdr", "../res/desert_sky/ny.hdr", "../res/desert_sky/pz.hdr", "../res/desert_sky/nx.hdr", "../res/desert_sky/px.hdr", "../res/desert_sky/py.hdr");
     UploadToGPU(&context->hdrMap);
     context->irradanceMap = MakeEmptyCubemap(64, 64, TextureFormat::RGB16F, TextureFilter::Bilinear, TextureWrapMode::ClampToEdge, false);
@@ -285,9 +283,6 @@ void FluxInit(Context* context) {
     GenIrradanceMap(context->renderer, &context->irradanceMap, context->hdrMap.gpuHandle);
     GenEnvPrefiliteredMap(context->renderer, &context->enviromentMap, context->hdrMap.gpuHandle, 6);
 
-    auto gameWorld = &context->gameWorld;
-    InitWorld(&context->gameWorld, context, &context->chunkMesher, 293847, Globals::DebugWorldName);
-
     auto stone = ResourceLoaderLoadImage("../res/tile_stone.png", DynamicRange::LDR, true, 3, PlatformAlloc, GlobalLogger, GlobalLoggerData);
     SetBlockTexture(context->renderer, BlockValue::Stone, stone->bits);
     auto grass = ResourceLoaderLoadImage("../res/tile_grass.png", DynamicRange::LDR, true, 3, PlatformAlloc, GlobalLogger, GlobalLoggerData);
@@ -530,6 +525,18 @@ void FluxInit(Context* context) {
     context->grenadeMaterial.pbr.metallicMap = &context->grenadeMetallic;
     context->grenadeMaterial.pbr.normalMap = &context->grenadeNormal;
     context->grenadeMaterial.pbr.AOMap = &context->grenadeAO;
+}
+
+void FluxInit(Context* context) {
+    log_print("Chunk size %llu\n", sizeof(Chunk));
+
+    if (!GetPlatform()->headless) {
+        FluxLoadAssets(context);
+    }
+
+    auto gameWorld = &context->gameWorld;
+    context->chunkMesher.mode = ChunkMeshMode::Binary;
+    InitWorld(&context->gameWorld, context, &context->chunkMesher, 293847, Globals::DebugWorldName);
 
     EntityInfoInit(&context->entityInfo);
     RegisterBuiltInEntities(context);
@@ -556,7 +563,65 @@ void FluxInit(Context* context) {
 void FluxReload(Context* context) {
 }
 
+void ProcessPendingEntityChanges(GameWorld* world) {
+    ForEach(&world->entitiesToMove, [&](auto it) {
+        auto entity = *it;
+        assert(entity);
+        UpdateEntityResidence(world, entity);
+    });
+
+    FlatArrayClear(&world->entitiesToMove);
+
+    ForEach(&world->entitiesToDelete, [&](Entity** it) {
+        auto entity = *it;
+        assert(entity);
+        assert(entity->deleted);
+        DeleteEntity(world, entity);
+    });
+
+    BucketArrayClear(&world->entitiesToDelete);
+}
+
+// NOTE: Idle main thread time at the end of the update goes into queued work (chunk generation mostly)
+void HelpUntilFrameDeadline() {
+    auto deadline = GetPlatform()->frameHelpDeadline;
+    if (deadline != 0.0) {
+        PlatformHelpUntil(nullptr, nullptr, deadline);
+    }
+}
+
+// NOTE: Simulation only tick. No player, input, UI or rendering. Render group is still
+// filled by entities, so it is just dropped at the end of the tick
+void FluxUpdateHeadless(Context* context) {
+    auto world = &context->gameWorld;
+    auto group = &context->renderGroup;
+    group->camera = &context->camera;
+
+    UpdateChunkEntities(&world->chunkPool, group, &context->camera);
+    UpdateChunks(&world->chunkPool, &context->camera);
+    ProcessPendingEntityChanges(world);
+
+    Reset(group);
+
+    if (GetPlatform()->tickCount % 60 == 0) {
+        u32 filledCount = 0;
+        u32 meshedCount = 0;
+        ForEachSimChunk(&world->chunkPool, [&](Chunk* chunk) {
+            if (chunk->filled) filledCount++;
+            if (chunk->primaryMeshValid) meshedCount++;
+        });
+        log_print("[Headless] Tick %llu: sim chunks: %lu, filled: %lu, meshed: %lu, rendered: %lu\n", GetPlatform()->tickCount, world->chunkPool.simChunkCount, filledCount, meshedCount, world->chunkPool.renderedChunkCount);
+    }
+
+    HelpUntilFrameDeadline();
+}
+
 void FluxUpdate(Context* context) {
+    if (GetPlatform()->headless) {
+        FluxUpdateHeadless(context);
+        return;
+    }
+
     auto world = &context->gameWorld;
     while (!world->playerID) {
         auto player = (Player*)CreatePlayerEntity(world, WorldPos::Make(0, 30, 0));
@@ -571,7 +636,7 @@ void FluxUpdate(Context* context) {
             EntityInventoryPushItem(player->toolbelt, Item::Extractor, 128);
             EntityInventoryPushItem(player->toolbelt, Item::Grenade, 128);
         }
-        UpdateChunks(&world->chunkPool);
+        UpdateChunks(&world->chunkPool, &context->camera);
         return;
     }
 
@@ -675,7 +740,7 @@ void FluxUpdate(Context* context) {
     UpdateChunkEntities(&world->chunkPool, group, camera);
 
 
-    UpdateChunks(&world->chunkPool);
+    UpdateChunks(&world->chunkPool, &context->camera);
 
     DrawChunks(&world->chunkPool, group, camera);
 
@@ -698,10 +763,12 @@ void FluxUpdate(Context* context) {
         v3 hitNormal;
         iv3 hitNormalInt;
 
+        auto cursor = MakeBlockCursor(&context->gameWorld, player->chunk, min);
         for (i32 z = min.z; z < max.z; z++) {
             for (i32 y = min.y; y < max.y; y++) {
                 for (i32 x = min.x; x < max.x; x++) {
-                    auto block = GetBlock(&context->gameWorld, x, y, z);
+                    SetBlockCursor(&cursor, IV3(x, y, z));
+                    auto block = GetBlock(&cursor);
                     if ((u32)(block.value) || block.entity) {
                         WorldPos voxelWorldP = WorldPos::Make(x, y, z);
                         v3 voxelRelP = WorldPos::Relative(camera->targetWorldPosition, voxelWorldP);
@@ -818,22 +885,7 @@ void FluxUpdate(Context* context) {
 
     }
 
-    ForEach(&context->gameWorld.entitiesToMove, [&](auto it) {
-        auto entity = *it;
-        assert(entity);
-        UpdateEntityResidence(&context->gameWorld, entity);
-    });
-
-    FlatArrayClear(&context->gameWorld.entitiesToMove);
-
-    ForEach(&context->gameWorld.entitiesToDelete, [&](Entity** it) {
-        auto entity = *it;
-        assert(entity);
-        assert(entity->deleted);
-        DeleteEntity(world, entity);
-    });
-
-    BucketArrayClear(&context->gameWorld.entitiesToDelete);
+    ProcessPendingEntityChanges(world);
 
 
     Begin(renderer, group);
@@ -844,6 +896,8 @@ void FluxUpdate(Context* context) {
     UpdateDebugProfiler(&context->debugProfiler);
     DebugUIUpdateAndRender(debugUI);
 
+    HelpUntilFrameDeadline();
+
     // Alpha
     //ImGui::PopStyleVar();
 }
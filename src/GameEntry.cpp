@@ -6,6 +6,7 @@
 #define DEBUG_OPENGL
 // NOTE: Defined only in debug build
 #include <stdlib.h>
+#include <new>
 
 void OpenglDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity, GLsizei length, const GLchar* message, const GLvoid* userParam);
 
@@ -86,13 +87,18 @@ void* PlatformAllocClear(uptr size) {
 }
 
 #define PlatformPushWork platform_call(PushWork)
+#define PlatformPushWorkWithCounter platform_call(PushWorkWithCounter)
+#define PlatformReleaseWorkCounter platform_call(ReleaseWorkCounter)
 #define PlatformCompleteAllWork platform_call(CompleteAllWork)
+#define PlatformHelpUntil platform_call(HelpUntil)
+#define PlatformWaitForWorkCounter platform_call(WaitForWorkCounter)
+#define PlatformGetScratchArena platform_call(GetScratchArena)
 #define PlatformSetSaveThreadWork platform_call(SetSaveThreadWork)
 
 #if defined(COMPILER_MSVC)
 #define gl_call(func) _GlobalPlatform->gl->functions.fn.##func
 #else
-#define platform_call(func) _GlobalPlatform->gl->functions.fn. func
+#define gl_call(func) _GlobalPlatform->gl->functions.fn. func
 #endif
 
 #define glGenTextures gl_call(glGenTextures)
@@ -225,11 +231,13 @@ extern "C" GAME_CODE_ENTRY void __cdecl GameUpdateAndRender(PlatformState* platf
         platform->gameSpeed = 1.0f;
 
 #if defined(DEBUG_OPENGL)
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-        glDebugMessageCallback(OpenglDebugCallback, 0);
-        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, 0, GL_TRUE);
-        glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, 0, GL_FALSE);
-        glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_OTHER, GL_DEBUG_SEVERITY_LOW, 0, 0, GL_FALSE);
+        if (!platform->headless) {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            glDebugMessageCallback(OpenglDebugCallback, 0);
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DONT_CARE, 0, 0, GL_TRUE);
+            glDebugMessageControl(GL_DONT_CARE, GL_DONT_CARE, GL_DEBUG_SEVERITY_NOTIFICATION, 0, 0, GL_FALSE);
+            glDebugMessageControl(GL_DONT_CARE, GL_DEBUG_TYPE_OTHER, GL_DEBUG_SEVERITY_LOW, 0, 0, GL_FALSE);
+        }
 #endif
         // NOTE: Looks like this syntax actually incorrect and somehow leads to stack owerflow in this case!
         //*context = {};
@@ -249,7 +257,17 @@ extern "C" GAME_CODE_ENTRY void __cdecl GameUpdateAndRender(PlatformState* platf
 
         log_print("[Info] Asynchronous GPU memory transfer supported: %s\n", platform->supportsAsyncGPUTransfer ? "true" : "false");
 
-        context->renderer = InitializeRenderer(gameArena, tempArena, UV2(GetPlatform()->windowWidth, GetPlatform()->windowHeight), 8);
+        if (platform->runHashMapBenchmark) {
+            RunHashMapBenchmark();
+        }
+
+        if (platform->runMesherBenchmark) {
+            RunChunkMesherBenchmark(&context->chunkMesher, tempArena);
+        }
+
+        if (!platform->headless) {
+            context->renderer = InitializeRenderer(gameArena, tempArena, UV2(GetPlatform()->windowWidth, GetPlatform()->windowHeight), 8);
+        }
 
         //context->renderer->clearColor = V4(0.8f, 0.8f, 0.8f, 1.0f);
         context->renderGroup = RenderGroup::Make(gameArena, Megabytes(32), 8192 * 2 * 2);
@@ -265,10 +283,14 @@ extern "C" GAME_CODE_ENTRY void __cdecl GameUpdateAndRender(PlatformState* platf
         _GlobalPlatform = platform;
         _GlobalContext = context;
 #if defined(DEBUG_OPENGL)
-        glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
-        glDebugMessageCallback(OpenglDebugCallback, 0);
+        if (!platform->headless) {
+            glEnable(GL_DEBUG_OUTPUT_SYNCHRONOUS);
+            glDebugMessageCallback(OpenglDebugCallback, 0);
+        }
 #endif
-        RecompileShaders(context->tempArena, context->renderer);
+        if (!platform->headless) {
+            RecompileShaders(context->tempArena, context->renderer);
+        }
         log_print("[Info] Game was hot-reloaded\n");
         FluxReload(context);
     } break;
@@ -331,6 +353,8 @@ void OpenglDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
 #include "HashMap.cpp"
 
 #include "World.cpp"
+#include "EntityPool.cpp"
+#include "EntityTable.cpp"
 #include "MeshGenerator.cpp"
 //#include "Region.cpp"
 #include "WorldGen.cpp"
@@ -359,6 +383,7 @@ void OpenglDebugCallback(GLenum source, GLenum type, GLuint id, GLenum severity,
 // NOTE: Platform specific intrinsics implementation begins here
 #if defined(PLATFORM_WINDOWS)
 #include <windows.h>
+#elif defined(PLATFORM_LINUX)
 #else
 #error Unsupported OS
 #endif
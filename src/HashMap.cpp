@@ -1,66 +1,188 @@
 #include "HashMap.h"
 
+void* HashMapAllocateTable(uptr bucketsSize, uptr probesSize) {
+    auto memory = (byte*)PlatformAlloc(bucketsSize + probesSize, 0, nullptr);
+    panic(memory, "[Hash map] Out of memory");
+    memset(memory + bucketsSize, 0, probesSize);
+    return memory;
+}
+
 hash_map_template_decl
 void Drop(hash_map_template* map) {
     if (map->size > 0) {
-        PlatformFree(map->table);
+        PlatformFree(map->table, nullptr);
+        if (map->oldTable) {
+            PlatformFree(map->oldTable, nullptr);
+        }
+        map->table = nullptr;
+        map->probes = nullptr;
+        map->oldTable = nullptr;
+        map->oldProbes = nullptr;
+        map->oldSize = 0;
+        map->migrateIndex = 0;
         map->size = 0;
         map->entryCount = 0;
     }
 }
 
+// NOTE: Returns bucket index or U32::Max
 hash_map_template_decl
-hash_bucket_teamplate* FindEntry(hash_map_template* map, Key* key, bool searchForEmpty) {
-    hash_bucket_teamplate* result = nullptr;
+u32 FindEntry(hash_map_template* map, Key* key) {
+    u32 result = U32::Max;
     u32 hashMask = map->size - 1;
-    u32 hash = HashFunction(key);
-    auto firstIndex = hash & hashMask;
-    for (u32 offset = 0; offset < map->size; offset++) {
-        u32 index = (firstIndex + offset) & hashMask;
-        auto entry = map->table + index;
-        if (searchForEmpty && (!entry->used)) {
-            result = entry;
+    u32 index = HashFunction(key) & hashMask;
+    // NOTE: Stored probe lengths are never greater than MaxProbeLength + 1, so the loop always ends
+    for (u32 probe = 1;; probe++) {
+        u32 entryProbe = map->probes[index];
+        if (entryProbe < probe) {
+            // NOTE: Empty bucket or an entry closer to its home than the key would be
+            break;
+        }
+        if (entryProbe == probe && CompareFunction(key, &map->table[index].key)) {
+            result = index;
             break;
-        } else if (entry->used && CompareFunction(key, &entry->key)) {
-            result = entry;
+        }
+        index = (index + 1) & hashMask;
+    }
+    return result;
+}
+
+// NOTE: Returns index of the entry which is still in the old table or U32::Max
+hash_map_template_decl
+u32 FindOldEntry(hash_map_template* map, Key* key) {
+    u32 result = U32::Max;
+    if (map->oldTable) {
+        u32 hashMask = map->oldSize - 1;
+        u32 index = HashFunction(key) & hashMask;
+        for (u32 probe = 1;; probe++) {
+            u32 entryProbe = map->oldProbes[index];
+            u32 probeLength = entryProbe & ~(u32)hash_map_template::TombstoneBit;
+            if (probeLength < probe) {
+                break;
+            }
+            if (probeLength == probe && !(entryProbe & hash_map_template::TombstoneBit) && CompareFunction(key, &map->oldTable[index].key)) {
+                // NOTE: Entries below migrateIndex are in the new table already
+                if (index >= map->migrateIndex) {
+                    result = index;
+                }
+                break;
+            }
+            index = (index + 1) & hashMask;
+        }
+    }
+    return result;
+}
+
+// NOTE: Inserts the entry which is not in the map. Entries it displaces are carried further.
+// Returns false if the carried entry gets too far from home, it is left in *entry then and the map should grow.
+// *placedIndex is the bucket where the original entry was put
+hash_map_template_decl
+bool InsertEntry(hash_map_template* map, hash_bucket_teamplate* entry, u32* placedIndex) {
+    bool result = false;
+    u32 hashMask = map->size - 1;
+    u32 index = HashFunction(&entry->key) & hashMask;
+    *placedIndex = U32::Max;
+    for (u32 probe = 1; probe <= hash_map_template::MaxProbeLength; probe++) {
+        u32 entryProbe = map->probes[index];
+        if (entryProbe == 0) {
+            map->probes[index] = (u8)probe;
+            map->table[index] = *entry;
+            if (*placedIndex == U32::Max) {
+                *placedIndex = index;
+            }
+            result = true;
             break;
         }
+        if (entryProbe < probe) {
+            auto tmp = map->table[index];
+            map->table[index] = *entry;
+            *entry = tmp;
+            map->probes[index] = (u8)probe;
+            probe = entryProbe;
+            if (*placedIndex == U32::Max) {
+                *placedIndex = index;
+            }
+        }
+        index = (index + 1) & hashMask;
     }
     return result;
 }
 
+hash_map_template_decl
+void MigrateBuckets(hash_map_template* map, u32 bucketCount) {
+    if (map->oldTable) {
+        auto end = Min(map->migrateIndex + bucketCount, map->oldSize);
+        for (u32 i = map->migrateIndex; i < end; i++) {
+            auto probe = map->oldProbes[i];
+            if (probe && !(probe & hash_map_template::TombstoneBit)) {
+                auto entry = map->oldTable[i];
+                u32 placedIndex;
+                auto inserted = InsertEntry(map, &entry, &placedIndex);
+                panic(inserted, "[Hash map] Probe length overflow while migrating. Hash function is probably broken");
+            }
+        }
+        map->migrateIndex = end;
+        if (map->migrateIndex == map->oldSize) {
+            PlatformFree(map->oldTable, nullptr);
+            map->oldTable = nullptr;
+            map->oldProbes = nullptr;
+            map->oldSize = 0;
+            map->migrateIndex = 0;
+        }
+    }
+}
+
 hash_map_template_decl
 void Grow(hash_map_template* map) {
+    if (map->oldTable) {
+        // NOTE: Shouldn't happen unless probes overflow, see MigrateBucketsPerWrite
+        log_print("[Hash map] Growing while previous migration is not finished. Finishing it now\n");
+        MigrateBuckets(map, map->oldSize);
+    }
     u32 newSize = map->size * hash_map_template::GrowKoef;
     log_print("[Hash map] Growing: old size %lu, old load %.3f, new size %lu new load %.3f\n", map->size, (f32)map->entryCount / (f32)map->size, newSize, (f32)map->entryCount / (f32)newSize);
     auto newMap = hash_map_template::Make(newSize);
-    for (u32 i = 0; i < map->size; i++) {
-        auto oldBucket = map->table + i;
-        if (oldBucket->used) {
-            Value* v = Add(&newMap, &oldBucket->key);
-            *v = oldBucket->value;
-        }
-    }
-    PlatformFree(map->table, nullptr);
+    map->oldTable = map->table;
+    map->oldProbes = map->probes;
+    map->oldSize = map->size;
+    map->migrateIndex = 0;
     map->table = newMap.table;
+    map->probes = newMap.probes;
     map->size = newSize;
 }
 
-
 hash_map_template_decl
 Value* Add(hash_map_template* map, Key* key) {
     Value* result = nullptr;
-    f32 load = (f32)(map->entryCount + 1) / (f32)map->size;
-    if (load > hash_map_template::LoadFactor) {
-        Grow(map);
-    }
+    MigrateBuckets(map, hash_map_template::MigrateBucketsPerWrite);
+    auto existing = FindEntry(map, key);
+    if (existing != U32::Max) {
+        result = &map->table[existing].value;
+    } else if ((existing = FindOldEntry(map, key)) != U32::Max) {
+        result = &map->oldTable[existing].value;
+    } else {
+        f32 load = (f32)(map->entryCount + 1) / (f32)map->size;
+        if (load > hash_map_template::LoadFactor) {
+            Grow(map);
+        }
 
-    auto entry = FindEntry(map, key, true);
-    if (entry) {
-        entry->used = true;
-        entry->key = *key;
+        hash_bucket_teamplate entry;
+        entry.key = *key;
+        entry.value = {};
+        u32 placedIndex;
+        if (InsertEntry(map, &entry, &placedIndex)) {
+            result = &map->table[placedIndex].value;
+        } else {
+            // NOTE: Entry in hand now is some displaced one, the new key is already in the table
+            // which becomes the old one. New table is empty, so the displaced entry fits right away
+            Grow(map);
+            auto inserted = InsertEntry(map, &entry, &placedIndex);
+            assert(inserted);
+            auto index = FindOldEntry(map, key);
+            assert(index != U32::Max);
+            result = &map->oldTable[index].value;
+        }
         map->entryCount++;
-        result = &entry->value;
     }
     return result;
 }
@@ -69,9 +191,14 @@ hash_map_template_decl
 Value* Get(hash_map_template* map, Key* key) {
     Value* result = nullptr;
     if (key) {
-        auto entry = FindEntry(map, key, false);
-        if (entry) {
-            result = &entry->value;
+        auto index = FindEntry(map, key);
+        if (index != U32::Max) {
+            result = &map->table[index].value;
+        } else {
+            index = FindOldEntry(map, key);
+            if (index != U32::Max) {
+                result = &map->oldTable[index].value;
+            }
         }
     }
     return result;
@@ -81,13 +208,151 @@ hash_map_template_decl
 bool Delete(hash_map_template* map, Key* key) {
     bool result = false;
     if (key) {
-        auto entry = FindEntry(map, key, false);
-        if (entry) {
+        MigrateBuckets(map, hash_map_template::MigrateBucketsPerWrite);
+        auto index = FindEntry(map, key);
+        if (index != U32::Max) {
             assert(map->entryCount);
-            entry->used = false;
+            // NOTE: Backward shift. Following entries which are not at home move one bucket closer to it
+            u32 hashMask = map->size - 1;
+            auto next = (index + 1) & hashMask;
+            while (map->probes[next] > 1) {
+                map->table[index] = map->table[next];
+                map->probes[index] = map->probes[next] - 1;
+                index = next;
+                next = (next + 1) & hashMask;
+            }
+            map->probes[index] = 0;
             map->entryCount--;
             result = true;
+        } else {
+            index = FindOldEntry(map, key);
+            if (index != U32::Max) {
+                assert(map->entryCount);
+                map->oldProbes[index] |= hash_map_template::TombstoneBit;
+                map->entryCount--;
+                result = true;
+            }
         }
     }
     return result;
 }
+
+//
+// NOTE: Benchmark. Run with linux_flux --bench-hash-map
+//
+
+u32 HashMapBenchmarkNaiveHash(void* value) {
+    iv3* p = (iv3*)value;
+    // NOTE: Old chunk hash
+    u32 hash = p->x * 12342 + p->y * 23423 + p->z * 13;
+    return hash;
+}
+
+template<HashFunctionFn* HashFunction>
+void RunHashMapBenchmark(const char* hashName, u32 radius, u32 churnSteps) {
+    HashMap<iv3, u32, HashFunction, ChunkHashCompFunc> map = HashMap<iv3, u32, HashFunction, ChunkHashCompFunc>::Make();
+    defer { Drop(&map); };
+
+    // NOTE: Keys are shaped like a chunk region: a square of columns over the world height
+    i32 r = (i32)radius;
+    // NOTE: Timing every add separately to catch spikes on growing. Max over all adds is mostly
+    // the OS noise, so adds which made the map grow are tracked apart
+    f64 insertTime = 0.0;
+    f64 maxAddTime = 0.0;
+    f64 maxGrowAddTime = 0.0;
+    u32 growCount = 0;
+    u32 count = 0;
+    for (i32 z = -r; z <= r; z++) {
+        for (i32 y = GameWorld::MinHeightChunk; y <= GameWorld::MaxHeightChunk; y++) {
+            for (i32 x = -r; x <= r; x++) {
+                auto key = IV3(x, y, z);
+                auto sizeBefore = map.size;
+                auto addBeginTime = PlatformGetTimeStamp();
+                *Add(&map, &key) = count++;
+                auto addTime = PlatformGetTimeStamp() - addBeginTime;
+                insertTime += addTime;
+                maxAddTime = Max(maxAddTime, addTime);
+                if (map.size != sizeBefore) {
+                    maxGrowAddTime = Max(maxGrowAddTime, addTime);
+                    growCount++;
+                }
+            }
+        }
+    }
+
+    u32 maxProbe = 0;
+    u64 probeSum = 0;
+    u32 probeCount = 0;
+    for (u32 i = 0; i < map.size; i++) {
+        u32 probe = map.probes[i];
+        if (probe) {
+            maxProbe = Max(maxProbe, probe);
+            probeSum += probe;
+            probeCount++;
+        }
+    }
+    u32 iteratedCount = 0;
+    auto it = Iterate(&map);
+    while (Next(&it)) {
+        assert(*it.value < count);
+        iteratedCount++;
+    }
+    assert(iteratedCount == map.entryCount);
+
+    auto beginTime = PlatformGetTimeStamp();
+    u32 hitCount = 0;
+    for (i32 z = -r; z <= r; z++) {
+        for (i32 y = GameWorld::MinHeightChunk; y <= GameWorld::MaxHeightChunk; y++) {
+            for (i32 x = -r; x <= r; x++) {
+                // NOTE: Every other lookup misses
+                auto hitKey = IV3(x, y, z);
+                auto missKey = IV3(x + 2 * r + 1, y, z);
+                if (Get(&map, &hitKey)) hitCount++;
+                if (Get(&map, &missKey)) hitCount++;
+            }
+        }
+    }
+    auto lookupTime = PlatformGetTimeStamp() - beginTime;
+
+    // NOTE: Region moves along x. Leaving slice is deleted, entering one is added
+    beginTime = PlatformGetTimeStamp();
+    u32 churnCount = 0;
+    for (i32 step = 0; step < (i32)churnSteps; step++) {
+        for (i32 z = -r; z <= r; z++) {
+            for (i32 y = GameWorld::MinHeightChunk; y <= GameWorld::MaxHeightChunk; y++) {
+                auto leaving = IV3(-r + step, y, z);
+                auto entering = IV3(r + step + 1, y, z);
+                auto deleted = Delete(&map, &leaving);
+                assert(deleted);
+                *Add(&map, &entering) = churnCount++;
+            }
+        }
+    }
+    auto churnTime = PlatformGetTimeStamp() - beginTime;
+    u32 churnOps = churnCount * 2;
+
+    // NOTE: Region after the churn should be in the map and nothing else
+    u32 foundCount = 0;
+    for (i32 z = -r; z <= r; z++) {
+        for (i32 y = GameWorld::MinHeightChunk; y <= GameWorld::MaxHeightChunk; y++) {
+            for (i32 x = -r + (i32)churnSteps; x <= r + (i32)churnSteps; x++) {
+                auto key = IV3(x, y, z);
+                if (Get(&map, &key)) foundCount++;
+            }
+        }
+    }
+    panic(foundCount == count && map.entryCount == count, "[Hash map] Benchmark: map lost entries");
+
+    log_print("[Hash map] %-6s %7lu keys: insert %7.2f ns/op (max %7.2f us, max of %lu growing %7.2f us), lookup %7.2f ns/op (%lu hits), churn %7.2f ns/op, probe avg %.2f max %lu, size %lu\n", hashName, count,
+              insertTime * 1.0e9 / count, maxAddTime * 1.0e6, growCount, maxGrowAddTime * 1.0e6, lookupTime * 1.0e9 / (count * 2), hitCount, churnTime * 1.0e9 / churnOps,
+              probeCount ? (f64)probeSum / probeCount : 0.0, maxProbe, map.size);
+}
+
+void RunHashMapBenchmark() {
+    // NOTE: Region radii around the current view distance and a few larger ones
+    const u32 radii[] = { 4, 8, 16, 32, 64 };
+    for (u32 i = 0; i < array_count(radii); i++) {
+        RunHashMapBenchmark<HashMapBenchmarkNaiveHash>("naive", radii[i], 2 * radii[i]);
+        RunHashMapBenchmark<ChunkHashFunc>("mixed", radii[i], 2 * radii[i]);
+    }
+}
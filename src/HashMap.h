@@ -1,24 +1,43 @@
 #pragma once
 
-//
-// TODO: Itartors
-//
-
 //
 // NOTE: IMPORTANT: Pointers returned by hash map functions are valid only
 // before next write to a map.
 //
 
+// NOTE: Robin Hood open addressing. Entry which is further from its home bucket takes the bucket
+// from an entry which is closer to its own, so probe lengths stay short and even. Lookup stops as soon
+// as it meets an entry closer to home than the key would be. Delete shifts following entries back
+// instead of leaving tombstones, so probe chains never break.
+//
+// NOTE: Growing doesn't rehash everything at once. Old table is kept and every write moves a few of its
+// buckets to the new one, lookups check both tables meanwhile. Buckets of the old table below migrateIndex
+// are already moved. Old table is never shifted, entries deleted from it get TombstoneBit instead,
+// so its probe chains stay valid until it is freed.
+
 template<typename Key, typename Value>
 struct HashBucket {
-    b32 used;
     Key key;
     Value value;
 };
 
+// NOTE: Allocates buckets followed by probes. Only probes are cleared
+void* HashMapAllocateTable(uptr bucketsSize, uptr probesSize);
+
 typedef u32(HashFunctionFn)(void*);
 typedef bool(CompareFunctionFn)(void*, void*);
 
+// NOTE: Finalizer of MurmurHash3. Every input bit affects every output bit,
+// so keys which differ only a bit (i.e. neighbor grid coords) don't cluster
+inline u64 HashMix64(u64 x) {
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    x *= 0xc4ceb9fe1a85ec53ull;
+    x ^= x >> 33;
+    return x;
+}
+
 #define hash_map_template_decl template<typename Key, typename Value, HashFunctionFn* HashFunction, CompareFunctionFn* CompareFunction>
 #define hash_map_template HashMap<Key, Value, HashFunction, CompareFunction>
 #define hash_map_iter_template HashMapIter<Key, Value, HashFunction, CompareFunction>
@@ -30,33 +49,103 @@ struct HashMap {
     // Totally random value
     static constexpr f32 LoadFactor = 0.8;
     static constexpr u32 GrowKoef = 2;
+    // NOTE: Probe lengths are kept in bytes. Map grows if an entry gets this far from its home bucket
+    static constexpr u32 MaxProbeLength = 127;
+    static constexpr u8 TombstoneBit = 0x80;
+    // NOTE: Old table has twice fewer buckets than the new one and the new one is filled to the load factor
+    // after (size * LoadFactor / 2) adds at least, so the migration is done long before the next growing
+    static constexpr u32 MigrateBucketsPerWrite = 16;
 
     u32 entryCount;
     u32 size = DefaultSize;
     HashBucket<Key, Value>* table;
+    // NOTE: Probe length + 1 of the entry in each bucket, zero for empty buckets. Kept apart from the buckets,
+    // so probing reads one byte per bucket and a run of them can be compared with SIMD
+    u8* probes;
+
+    // NOTE: Table which is being migrated. Null if there is no migration
+    HashBucket<Key, Value>* oldTable;
+    u8* oldProbes;
+    u32 oldSize;
+    u32 migrateIndex;
 
     static HashMap Make(u32 size = DefaultSize) {
+        assert(IsPowerOfTwo(size));
         HashMap map = {};
-        map.table = (HashBucket<Key, Value>*)PlatformAllocClear(sizeof(HashBucket<Key, Value>) * size);
+        // NOTE: Single allocation, probes go after the buckets. Buckets are not cleared, so a big table
+        // doesn't get touched all at once when it's made
+        map.table = (HashBucket<Key, Value>*)HashMapAllocateTable(sizeof(HashBucket<Key, Value>) * size, sizeof(u8) * size);
+        map.probes = (u8*)(map.table + size);
         map.size = size;
         return map;
     }
+};
 
+// NOTE: Iteration. Map shouldn't be modified while iterating
+//
+// auto it = Iterate(&map);
+// while (Next(&it)) { it.key, it.value }
+//
+hash_map_template_decl
+struct HashMapIter {
+    hash_map_template* map;
+    u32 index;
+    Key* key;
+    Value* value;
 };
 
+hash_map_template_decl
+inline hash_map_iter_template Iterate(hash_map_template* map) {
+    hash_map_iter_template it = {};
+    it.map = map;
+    return it;
+}
+
+// NOTE: Walks the table, then not yet migrated part of the old table
+hash_map_template_decl
+inline bool Next(hash_map_iter_template* it) {
+    bool result = false;
+    auto map = it->map;
+    while (it->index < map->size) {
+        auto index = it->index++;
+        if (map->probes[index]) {
+            it->key = &map->table[index].key;
+            it->value = &map->table[index].value;
+            result = true;
+            break;
+        }
+    }
+    if (!result && map->oldTable) {
+        if (it->index < map->size + map->migrateIndex) {
+            it->index = map->size + map->migrateIndex;
+        }
+        while (it->index < map->size + map->oldSize) {
+            auto index = (it->index++) - map->size;
+            auto probe = map->oldProbes[index];
+            if (probe && !(probe & hash_map_template::TombstoneBit)) {
+                it->key = &map->oldTable[index].key;
+                it->value = &map->oldTable[index].value;
+                result = true;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
 template<typename Key, typename Value, HashFunctionFn* HashFunction, CompareFunctionFn* CompareFunction, typename F>
 void ForEach(hash_map_template* map, F func) {
-    for (usize i = 0; i < map->size; i++) {
-        if (map->table[at].used) {
-            auto entry = &map->table[i].value;
-            func(entry);
-        }
+    auto it = Iterate(map);
+    while (Next(&it)) {
+        func(it.key, it.value);
     }
 }
 
 hash_map_template_decl
 void Drop(hash_map_template* map);
 
+// NOTE: Returns value of the existing entry if the key is already in the map.
+// Value of a new entry is zeroed
 hash_map_template_decl
 Value* Add(hash_map_template* map, Key* key);
 
@@ -65,3 +154,5 @@ Value* Get(hash_map_template* map, Key* key);
 
 hash_map_template_decl
 bool Delete(hash_map_template* map, Key* key);
+
+void RunHashMapBenchmark();
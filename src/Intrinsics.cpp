@@ -26,6 +26,30 @@ u32 AtomicLoad(u32 volatile* value) {
     return *value;
 }
 
+#elif defined(PLATFORM_LINUX)
 
+u32 AtomicCompareExchange(u32 volatile* dest, u32 comp, u32 newValue) {
+    return __sync_val_compare_and_swap(dest, comp, newValue);
+}
+
+u32 AtomicExchange(u32 volatile* dest, u32 value) {
+    return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+}
+
+u64 AtomicExchange(u64 volatile* dest, u64 value) {
+    return __atomic_exchange_n(dest, value, __ATOMIC_SEQ_CST);
+}
+
+u32 AtomicIncrement(u32 volatile* dest) {
+    return __atomic_add_fetch(dest, 1, __ATOMIC_SEQ_CST);
+}
+
+u32 AtomicDecrement(u32 volatile* dest) {
+    return __atomic_sub_fetch(dest, 1, __ATOMIC_SEQ_CST);
+}
+
+u32 AtomicLoad(u32 volatile* value) {
+    return __atomic_load_n(value, __ATOMIC_SEQ_CST);
+}
 
 #endif
@@ -13,6 +13,18 @@ u32 AtomicLoad(u32 volatile* value);
 
 u32 ThreadSleep(u32 ms);
 
+// NOTE: Index of the lowest set bit. Value must not be zero
+inline u32 CountTrailingZeros(u64 value) {
+    assert(value);
+#if defined(COMPILER_MSVC)
+    unsigned long index;
+    _BitScanForward64(&index, value);
+    return (u32)index;
+#else
+    return (u32)__builtin_ctzll(value);
+#endif
+}
+
 // NOTE: https://graphics.stanford.edu/~seander/bithacks.html#RoundUpPowerOf2
 constexpr u32 NextPowerOfTwo(u32 v) {
     v--;
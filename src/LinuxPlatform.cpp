@@ -0,0 +1,720 @@
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <wchar.h>
+#include <time.h>
+#include <errno.h>
+#include <limits.h>
+#include <float.h>
+#include <locale.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <fnmatch.h>
+#include <dlfcn.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+// NOTE: System headers go first since Common.h defines some short macros (constant, etc.)
+#include "LinuxPlatform.h"
+#include "Memory.h"
+
+static LinuxContext GlobalContext = {};
+static void* GlobalGameData = 0;
+// NOTE: Index of the work queue deque owned by the current thread
+static thread_local u32 GlobalThreadIndex = WorkQueueForeignThread;
+
+void Logger(void* data, const char* fmt, va_list* args) {
+    vprintf(fmt, *args);
+}
+
+LoggerFn* GlobalLogger = Logger;
+void* GlobalLoggerData = nullptr;
+
+inline void AssertHandler(void* data, const char* file, const char* func, u32 line, const char* assertStr, const char* fmt, va_list* args) {
+    log_print("[Assertion failed] Expression (%s) result is false\nFile: %s, function: %s, line: %d.\n", assertStr, file, func, (int)line);
+    if (args) {
+        GlobalLogger(GlobalLoggerData, fmt, args);
+    }
+    debug_break();
+}
+
+AssertHandlerFn* GlobalAssertHandler = AssertHandler;
+void* GlobalAssertHandlerData = nullptr;
+
+// NOTE: Game code uses windows-style wide paths. Converting them to utf-8 and replacing separators
+bool LinuxConvertPath(const wchar_t* path, char* buffer, u32 bufferSize) {
+    bool result = false;
+    auto size = wcstombs(buffer, path, bufferSize);
+    if (size != (size_t)-1 && size < bufferSize) {
+        for (u32 i = 0; i < size; i++) {
+            if (buffer[i] == '\\') {
+                buffer[i] = '/';
+            }
+        }
+        result = true;
+    }
+    return result;
+}
+
+bool LinuxForEachFile(const wchar_t* wildcard, void* data, ForEachFileCallbackFn* callback) {
+    bool result = false;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(wildcard, path, array_count(path))) {
+        const char* dirName = ".";
+        const char* pattern = path;
+        auto separator = strrchr(path, '/');
+        if (separator) {
+            *separator = 0;
+            dirName = path;
+            pattern = separator + 1;
+        }
+        DIR* dir = opendir(dirName);
+        if (dir) {
+            result = true;
+            struct dirent* entry;
+            while ((entry = readdir(dir))) {
+                if (fnmatch(pattern, entry->d_name, 0) == 0) {
+                    char fullName[PATH_MAX];
+                    auto fullNameLength = snprintf(fullName, array_count(fullName), "%s/%s", dirName, entry->d_name);
+                    struct stat fileStat;
+                    // TODO: Ignoring direcotries for now
+                    if ((fullNameLength > 0) && ((usize)fullNameLength < array_count(fullName)) && stat(fullName, &fileStat) == 0 && S_ISREG(fileStat.st_mode)) {
+                        wchar_t wideName[PATH_MAX];
+                        if (mbstowcs(wideName, entry->d_name, array_count(wideName)) != (size_t)-1) {
+                            FileInfo info;
+                            info.name = wideName;
+                            info.size = (u64)fileStat.st_size;
+                            callback(&info, data);
+                        }
+                    }
+                }
+            }
+            closedir(dir);
+        }
+    }
+    return result;
+}
+
+u32 DebugGetFileSize(const wchar_t* filename) {
+    u32 fileSize = 0;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(filename, path, array_count(path))) {
+        struct stat fileStat;
+        if (stat(path, &fileStat) == 0) {
+            fileSize = (u32)fileStat.st_size;
+        }
+    }
+    return fileSize;
+}
+
+u32 DebugReadFileToBuffer(void* buffer, u32 bufferSize, const wchar_t* filename) {
+    u32 written = 0;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(filename, path, array_count(path))) {
+        int fd = open(path, O_RDONLY);
+        if (fd != -1) {
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0) {
+                u32 readSize = bufferSize;
+                if ((u64)fileStat.st_size < bufferSize) {
+                    readSize = (u32)fileStat.st_size;
+                }
+                if (buffer) {
+                    auto read = ::read(fd, buffer, readSize);
+                    if (read != (ssize_t)readSize) {
+                        log_print("[Warn] Failed to open file");
+                    } else {
+                        written = (u32)read;
+                    }
+                }
+            }
+            close(fd);
+        }
+    }
+    return written;
+}
+
+u32 DebugReadTextFileToBuffer(void* buffer, u32 bufferSize, const wchar_t* filename) {
+    u32 bytesRead = 0;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(filename, path, array_count(path))) {
+        int fd = open(path, O_RDONLY);
+        if (fd != -1) {
+            struct stat fileStat;
+            if (fstat(fd, &fileStat) == 0) {
+                if ((u64)fileStat.st_size + 1 > bufferSize) {
+                    log_print("[Warn] Failed to open file");
+                } else if (buffer) {
+                    auto read = ::read(fd, buffer, (size_t)fileStat.st_size);
+                    if (read != (ssize_t)fileStat.st_size) {
+                        log_print("[Warn] Failed to open file");
+                    } else {
+                        ((char*)buffer)[fileStat.st_size] = '\0';
+                        bytesRead = (u32)fileStat.st_size + 1;
+                    }
+                }
+            }
+            close(fd);
+        }
+    }
+    return bytesRead;
+}
+
+bool DebugWriteFile(const wchar_t* filename, void* data, u32 dataSize) {
+    bool result = false;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(filename, path, array_count(path))) {
+        int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd != -1) {
+            auto written = write(fd, data, dataSize);
+            if (written == (ssize_t)dataSize) {
+                result = true;
+            }
+            close(fd);
+        }
+    }
+    return result;
+}
+
+FileHandle DebugOpenFile(const wchar_t* filename) {
+    FileHandle result = InvalidFileHandle;
+    char path[PATH_MAX];
+    if (LinuxConvertPath(filename, path, array_count(path))) {
+        int fd = open(path, O_RDWR | O_CREAT | O_EXCL, 0644);
+        if (fd != -1) {
+            result = (FileHandle)fd;
+        }
+    }
+    return result;
+}
+
+bool DebugCloseFile(FileHandle handle) {
+    bool result = close((int)handle) == 0;
+    return result;
+}
+
+u32 DebugWriteToOpenedFile(FileHandle handle, void* data, u32 size) {
+    u32 result = 0;
+    auto written = write((int)handle, data, size);
+    if (written == (ssize_t)size) {
+        result = size;
+    }
+    return result;
+}
+
+b32 DebugCopyFile(const wchar_t* source, const wchar_t* dest, bool overwrite) {
+    b32 result = false;
+    char sourcePath[PATH_MAX];
+    char destPath[PATH_MAX];
+    if (LinuxConvertPath(source, sourcePath, array_count(sourcePath)) && LinuxConvertPath(dest, destPath, array_count(destPath))) {
+        int sourceFd = open(sourcePath, O_RDONLY);
+        if (sourceFd != -1) {
+            int flags = O_WRONLY | O_CREAT | (overwrite ? O_TRUNC : O_EXCL);
+            int destFd = open(destPath, flags, 0644);
+            if (destFd != -1) {
+                result = true;
+                char buffer[4096];
+                ssize_t read;
+                while ((read = ::read(sourceFd, buffer, sizeof(buffer))) > 0) {
+                    if (write(destFd, buffer, read) != read) {
+                        result = false;
+                        break;
+                    }
+                }
+                if (read < 0) {
+                    result = false;
+                }
+                close(destFd);
+            }
+            close(sourceFd);
+        }
+    }
+    return result;
+}
+
+f64 GetTimeStamp() {
+    timespec time;
+    clock_gettime(CLOCK_MONOTONIC, &time);
+    return (f64)time.tv_sec + (f64)time.tv_nsec / 1000000000.0;
+}
+
+DateTime GetLocalTime() {
+    DateTime dateTime = {};
+    timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    tm local;
+    if (localtime_r(&now.tv_sec, &local)) {
+        dateTime.year = (u16)(local.tm_year + 1900);
+        dateTime.month = (u16)(local.tm_mon + 1);
+        dateTime.dayOfWeek = (u16)local.tm_wday;
+        dateTime.day = (u16)local.tm_mday;
+        dateTime.hour = (u16)local.tm_hour;
+        dateTime.minute = (u16)local.tm_min;
+        dateTime.seconds = (u16)local.tm_sec;
+        dateTime.milliseconds = (u16)(now.tv_nsec / 1000000);
+    }
+    return dateTime;
+}
+
+void* Allocate(uptr size, uptr alignment, void* data) {
+    auto memory = malloc(size);
+    assert(memory);
+    return memory;
+}
+
+void Deallocate(void* ptr, void* data) {
+    free(ptr);
+}
+
+void* Reallocate(void* ptr, uptr newSize) {
+    return realloc(ptr, newSize);
+}
+
+void LinuxSleep(u32 ms) {
+    timespec time;
+    time.tv_sec = ms / 1000;
+    time.tv_nsec = (ms % 1000) * 1000000;
+    nanosleep(&time, nullptr);
+}
+
+// NOTE: Every GL entry point is pointed to this stub, so accidental calls in headless mode are no-ops
+static uptr NullGLFunction() { return 0; }
+
+OpenGL* LoadNullOpenGL() {
+    auto context = (OpenGL*)calloc(1, sizeof(OpenGL));
+    panic(context);
+    for (u32 i = 0; i < OpenGL::FunctionCount; i++) {
+        context->functions.raw[i] = (void*)NullGLFunction;
+    }
+    return context;
+}
+
+void LinuxSignalWorkers() {
+    // NOTE: Capping semaphore at the number of workers like on win32, so a burst of work doesn't
+    // leave thousands of wakeups behind. The check is racy but at worst we post an extra wakeup
+    int value = 0;
+    sem_getvalue(&GlobalContext.workQueueSemaphore, &value);
+    if (value < (int)NumOfWorkerThreads) {
+        sem_post(&GlobalContext.workQueueSemaphore);
+    }
+}
+
+b32 LinuxPushWorkWithCounter(WorkQueue* queue, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2) {
+    b32 result = true;
+    if (GlobalThreadIndex != WorkQueueForeignThread) {
+        WorkQueuePush(queue, GlobalThreadIndex, counter, fn, data0, data1, data2);
+    } else {
+        // NOTE: Threads outside of the pool don't have deques
+        result = WorkQueueInject(queue, counter, fn, data0, data1, data2);
+    }
+    return result;
+}
+
+b32 LinuxPushWork(WorkQueue* queue, WorkFn* fn, void* data0, void* data1, void* data2) {
+    return LinuxPushWorkWithCounter(queue, nullptr, fn, data0, data1, data2);
+}
+
+void LinuxReleaseWorkCounter(WorkCounter* counter) {
+    WorkCounterRelease(counter, GlobalThreadIndex);
+}
+
+b32 LinuxHelpUntil(HelpConditionFn* condition, void* data, f64 deadline) {
+    panic(GlobalThreadIndex != WorkQueueForeignThread, "[Linux] Only main and worker threads can help with work");
+    WorkQueue* queues[] = { &GlobalContext.highPriorityQueue, &GlobalContext.lowPriorityQueue };
+    return WorkQueuesHelpUntil(queues, array_count(queues), GlobalThreadIndex, condition, data, deadline);
+}
+
+void LinuxWaitForWorkCounter(WorkCounter* counter) {
+    LinuxHelpUntil(WorkCounterIsZeroCondition, counter, 0.0);
+}
+
+// NOTE: Helps with both queues, work in this one might wait on the other one
+void LinuxCompleteAllWork(WorkQueue* queue) {
+    LinuxHelpUntil(WorkQueueIsEmptyCondition, queue, 0.0);
+}
+
+MemoryArena* LinuxGetScratchArena() {
+    panic(GlobalThreadIndex != WorkQueueForeignThread, "[Linux] Scratch arenas are owned only by main and worker threads");
+    return GlobalContext.scratchArenas[GlobalThreadIndex];
+}
+
+void* LinuxThreadProc(void* param) {
+    auto threadInfo = (LinuxThreadInfo*)param;
+    auto lowPriorityQueue = threadInfo->lowPriorityQueue;
+    auto highPriorityQueue = threadInfo->highPriorityQueue;
+    GlobalThreadIndex = threadInfo->index;
+    while (true) {
+        auto didHighPriorityWork = WorkQueueDoWork(highPriorityQueue, threadInfo->index);
+        if (!didHighPriorityWork) {
+            auto didLowPriorityWork = WorkQueueDoWork(lowPriorityQueue, threadInfo->index);
+            if (!didLowPriorityWork) {
+                while (sem_wait(&GlobalContext.workQueueSemaphore) == -1 && errno == EINTR) {}
+            }
+        }
+    }
+    return nullptr;
+}
+
+void* LinuxSaveThreadProc(void* param) {
+    while (true) {
+        pthread_mutex_lock(&GlobalContext.saveThreadMutex);
+
+        if (GlobalContext.SaveThreadWork) {
+            GlobalContext.SaveThreadWork(GlobalContext.SaveThreadData);
+        }
+
+        auto timeout = GlobalContext.saveTimeout;
+        pthread_mutex_unlock(&GlobalContext.saveThreadMutex);
+
+        LinuxSleep(timeout);
+    }
+    return nullptr;
+}
+
+void LinuxSetSaveThreadWork(SaveThreadWorkFn* func, void* data, u32 timeoutMs) {
+    pthread_mutex_lock(&GlobalContext.saveThreadMutex);
+    GlobalContext.SaveThreadData = data;
+    GlobalContext.SaveThreadWork = func;
+    GlobalContext.saveTimeout = timeoutMs;
+    pthread_mutex_unlock(&GlobalContext.saveThreadMutex);
+    if (!GlobalContext.saveThreadStarted) {
+        auto result = pthread_create(&GlobalContext.saveThread, nullptr, LinuxSaveThreadProc, nullptr);
+        panic(result == 0, "[Linux] Failed to create save thread");
+        pthread_detach(GlobalContext.saveThread);
+        GlobalContext.saveThreadStarted = true;
+    }
+}
+
+void* LinuxAllocatePages(uptr size) {
+    void* block = mmap(0, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    assert(block != MAP_FAILED);
+    return block;
+}
+
+void LinuxDeallocatePages(void* memory, uptr size) {
+    auto result = munmap(memory, size);
+    assert(result == 0);
+}
+
+uptr LinuxGetPageSize() {
+    static uptr pageSize = (uptr)sysconf(_SC_PAGESIZE);
+    return pageSize;
+}
+
+bool LinuxCommitMemory(void* memory, uptr size) {
+    auto pageSize = LinuxGetPageSize();
+    auto begin = AlignDown((uptr)memory, pageSize);
+    auto end = AlignUp((uptr)memory + size, pageSize);
+    auto result = mprotect((void*)begin, end - begin, PROT_READ | PROT_WRITE);
+    return result == 0;
+}
+
+// NOTE: Only pages which are entirely inside the range. Edge pages might be shared with a neighbour
+void LinuxDecommitMemory(void* memory, uptr size) {
+    auto pageSize = LinuxGetPageSize();
+    auto begin = AlignUp((uptr)memory, pageSize);
+    auto end = AlignDown((uptr)memory + size, pageSize);
+    if (end > begin) {
+        auto result = madvise((void*)begin, end - begin, MADV_DONTNEED);
+        assert(result == 0);
+        result = mprotect((void*)begin, end - begin, PROT_NONE);
+        assert(result == 0);
+    }
+}
+
+// NOTE: Only reserves address space. Arena commits pages as it grows
+MemoryArena* LinuxAllocateArena(uptr size) {
+    uptr headerSize = sizeof(MemoryArena);
+    void* mem = mmap(0, size + headerSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    assert(mem != MAP_FAILED, "Allocation failed");
+    assert((uptr)mem % 128 == 0, "Memory aligment violation");
+    auto committed = LinuxCommitMemory(mem, headerSize);
+    assert(committed, "Commit failed");
+    MemoryArena header = {};
+    header.free = size;
+    header.size = size;
+    header.begin = (void*)((byte*)mem + headerSize);
+    header.retainSize = MemoryArenaDefaultRetainSize;
+    header.Commit = LinuxCommitMemory;
+    header.Decommit = LinuxDecommitMemory;
+    memcpy(mem, &header, sizeof(MemoryArena));
+    return (MemoryArena*)mem;
+}
+
+void LinuxFreeArena(MemoryArena* arena) {
+    void* base = (void*)((byte*)arena->begin - sizeof(MemoryArena));
+    auto result = munmap(base, arena->size + sizeof(MemoryArena));
+    assert(result == 0);
+}
+
+bool LoadGameCode(LinuxLibraryData* lib) {
+    bool result = false;
+    lib->handle = dlopen(LinuxLibraryData::LibName, RTLD_NOW | RTLD_LOCAL);
+    if (lib->handle) {
+        auto gameUpdateAndRender = (GameUpdateAndRenderFn*)dlsym(lib->handle, "GameUpdateAndRender");
+        if (gameUpdateAndRender) {
+            lib->GameUpdateAndRender = gameUpdateAndRender;
+            result = true;
+        } else {
+            log_print("[Error] Failed to get GameUpdateAndRender() address.\n");
+        }
+    } else {
+        log_print("[Error] Failed to load game library: %s\n", dlerror());
+    }
+    return result;
+}
+
+void WorkQueueStressLeafWork(void* data0, void* data1, void* data2, u32 threadIndex, MemoryArena* scratch) {
+    auto test = (WorkQueueStressTest*)data0;
+    auto index = (u32)(uptr)data1;
+    __sync_add_and_fetch(test->runCounts + index, 1);
+}
+
+void WorkQueueStressSpawnerWork(void* data0, void* data1, void* data2, u32 threadIndex, MemoryArena* scratch) {
+    auto test = (WorkQueueStressTest*)data0;
+    auto spawner = (u32)(uptr)data1;
+    u32 begin = WorkQueueStressTest::ProducerCount * WorkQueueStressTest::JobsPerProducer + spawner * WorkQueueStressTest::JobsPerSpawner;
+    for (u32 i = 0; i < WorkQueueStressTest::JobsPerSpawner; i++) {
+        auto pushed = LinuxPushWork(test->queue, WorkQueueStressLeafWork, test, (void*)(uptr)(begin + i), nullptr);
+        panic(pushed, "[Linux] Failed to push work from a worker");
+    }
+}
+
+struct WorkQueueStressProducer {
+    WorkQueueStressTest* test;
+    u32 index;
+};
+
+void* WorkQueueStressProducerProc(void* param) {
+    auto producer = (WorkQueueStressProducer*)param;
+    auto test = producer->test;
+    u32 begin = producer->index * WorkQueueStressTest::JobsPerProducer;
+    for (u32 i = 0; i < WorkQueueStressTest::JobsPerProducer; i++) {
+        while (!LinuxPushWork(test->queue, WorkQueueStressLeafWork, test, (void*)(uptr)(begin + i), nullptr)) {
+            sched_yield();
+        }
+    }
+    __sync_add_and_fetch(&test->producersFinished, 1);
+    return nullptr;
+}
+
+bool LinuxRunWorkQueueStressTest(WorkQueue* queue) {
+    log_print("[Linux] Work queue stress test: %lu jobs from %lu foreign threads and %lu spawner jobs\n", WorkQueueStressTest::JobCount, WorkQueueStressTest::ProducerCount, WorkQueueStressTest::SpawnerCount);
+    auto beginTime = GetTimeStamp();
+    WorkQueueStressTest test {};
+    test.queue = queue;
+    test.runCounts = (u32 volatile*)calloc(WorkQueueStressTest::JobCount, sizeof(u32));
+    panic(test.runCounts, "[Linux] Failed to allocate stress test counters");
+
+    WorkQueueStressProducer producers[WorkQueueStressTest::ProducerCount];
+    pthread_t producerThreads[WorkQueueStressTest::ProducerCount];
+    for (u32 i = 0; i < WorkQueueStressTest::ProducerCount; i++) {
+        producers[i] = WorkQueueStressProducer { &test, i };
+        auto result = pthread_create(producerThreads + i, nullptr, WorkQueueStressProducerProc, producers + i);
+        panic(result == 0, "[Linux] Failed to create producer thread");
+    }
+
+    for (u32 i = 0; i < WorkQueueStressTest::SpawnerCount; i++) {
+        LinuxPushWork(queue, WorkQueueStressSpawnerWork, &test, (void*)(uptr)i, nullptr);
+    }
+
+    while (test.producersFinished < WorkQueueStressTest::ProducerCount || !WorkQueueIsEmpty(queue)) {
+        if (!WorkQueueDoWork(queue, GlobalThreadIndex)) {
+            sched_yield();
+        }
+    }
+
+    for (u32 i = 0; i < WorkQueueStressTest::ProducerCount; i++) {
+        pthread_join(producerThreads[i], nullptr);
+    }
+
+    u32 failedCount = 0;
+    for (u32 i = 0; i < WorkQueueStressTest::JobCount; i++) {
+        if (test.runCounts[i] != 1) {
+            if (failedCount < 16) {
+                log_print("[Linux] Job %lu ran %lu times\n", i, test.runCounts[i]);
+            }
+            failedCount++;
+        }
+    }
+    free((void*)test.runCounts);
+
+    auto time = GetTimeStamp() - beginTime;
+    if (failedCount) {
+        log_print("[Linux] Work queue stress test failed: %lu jobs ran not exactly once\n", failedCount);
+    } else {
+        log_print("[Linux] Work queue stress test passed in %.3f ms\n", time * 1000.0);
+    }
+    return failedCount == 0;
+}
+
+void LinuxParseCommandLine(LinuxContext* app, int argCount, char** args) {
+    for (int i = 1; i < argCount; i++) {
+        if (strcmp(args[i], "--ticks") == 0 && (i + 1) < argCount) {
+            app->ticksToRun = strtoull(args[i + 1], nullptr, 10);
+            i++;
+        } else if (strcmp(args[i], "--fixed") == 0) {
+            app->fixedTimestep = true;
+        } else if (strcmp(args[i], "--stress-work-queue") == 0) {
+            app->runWorkQueueStressTest = true;
+        } else if (strcmp(args[i], "--bench-hash-map") == 0) {
+            app->state.runHashMapBenchmark = true;
+        } else if (strcmp(args[i], "--bench-mesher") == 0) {
+            app->state.runMesherBenchmark = true;
+        } else {
+            log_print("[Linux] Unknown argument: %s\nUsage: linux_flux [--ticks N] [--fixed] [--stress-work-queue] [--bench-hash-map] [--bench-mesher]\n", args[i]);
+        }
+    }
+}
+
+int main(int argCount, char** args) {
+    auto app = &GlobalContext;
+
+    // NOTE: Needed for wide path conversion
+    setlocale(LC_ALL, "");
+
+    app->ticksToRun = 600;
+    LinuxParseCommandLine(app, argCount, args);
+
+    app->state.headless = true;
+    app->state.supportsAsyncGPUTransfer = false;
+    app->state.windowWidth = 1280;
+    app->state.windowHeight = 720;
+
+    pthread_mutex_init(&app->saveThreadMutex, nullptr);
+    app->saveTimeout = 3000;
+
+    auto lowQueue = &app->lowPriorityQueue;
+    auto highQueue = &app->highPriorityQueue;
+
+    for (u32x i = 0; i < array_count(app->scratchArenas); i++) {
+        app->scratchArenas[i] = LinuxAllocateArena(WorkScratchArenaSize);
+        app->scratchArenas[i]->isTemporary = true;
+    }
+
+    // NOTE: Workers get indices [0, NumOfWorkerThreads), main thread is the last one
+    InitWorkQueue(lowQueue, NumOfWorkerThreads + 1, LinuxSignalWorkers, app->scratchArenas);
+    InitWorkQueue(highQueue, NumOfWorkerThreads + 1, LinuxSignalWorkers, app->scratchArenas);
+    GlobalThreadIndex = NumOfWorkerThreads;
+
+    auto semaphoreResult = sem_init(&app->workQueueSemaphore, 0, 0);
+    panic(semaphoreResult == 0, "[Linux] Failed to create work queue semaphore");
+
+    for (u32x i = 0; i < array_count(app->threadInfo); i++) {
+        auto info = app->threadInfo + i;
+        info->index = i;
+        info->lowPriorityQueue = lowQueue;
+        info->highPriorityQueue = highQueue;
+        pthread_t thread;
+        auto result = pthread_create(&thread, nullptr, LinuxThreadProc, (void*)info);
+        panic(result == 0, "[Linux] Failed to create worker thread");
+        pthread_detach(thread);
+    }
+
+    if (app->runWorkQueueStressTest) {
+        auto passed = LinuxRunWorkQueueStressTest(lowQueue);
+        return passed ? 0 : 1;
+    }
+
+    app->state.gl = LoadNullOpenGL();
+
+    app->state.functions.DebugGetFileSize = DebugGetFileSize;
+    app->state.functions.DebugReadFile = DebugReadFileToBuffer;
+    app->state.functions.DebugReadTextFile = DebugReadTextFileToBuffer;
+    app->state.functions.DebugWriteFile = DebugWriteFile;
+    app->state.functions.DebugOpenFile = DebugOpenFile;
+    app->state.functions.DebugCloseFile = DebugCloseFile;
+    app->state.functions.DebugCopyFile = DebugCopyFile;
+    app->state.functions.DebugWriteToOpenedFile = DebugWriteToOpenedFile;
+
+    app->state.functions.Allocate = Allocate;
+    app->state.functions.Deallocate = Deallocate;
+    app->state.functions.Reallocate = Reallocate;
+
+    app->state.functions.AllocatePages = LinuxAllocatePages;
+    app->state.functions.DeallocatePages = LinuxDeallocatePages;
+
+    app->state.functions.AllocateArena = LinuxAllocateArena;
+    app->state.functions.FreeArena = LinuxFreeArena;
+
+    app->state.functions.PushWork = LinuxPushWork;
+    app->state.functions.PushWorkWithCounter = LinuxPushWorkWithCounter;
+    app->state.functions.ReleaseWorkCounter = LinuxReleaseWorkCounter;
+    app->state.functions.CompleteAllWork = LinuxCompleteAllWork;
+    app->state.functions.HelpUntil = LinuxHelpUntil;
+    app->state.functions.WaitForWorkCounter = LinuxWaitForWorkCounter;
+    app->state.functions.GetScratchArena = LinuxGetScratchArena;
+    app->state.functions.SetSaveThreadWork = LinuxSetSaveThreadWork;
+
+    app->state.functions.GetTimeStamp = GetTimeStamp;
+
+    app->state.functions.ForEachFile = LinuxForEachFile;
+
+    app->state.lowPriorityQueue = lowQueue;
+    app->state.highPriorityQueue = highQueue;
+
+    b32 codeLoaded = LoadGameCode(&app->gameLib);
+    panic(codeLoaded, "Failed to load game lib");
+
+    app->state.localTime = GetLocalTime();
+    app->state.gameSpeed = 1.0f;
+    app->state.absDeltaTime = (f32)SECONDS_PER_TICK;
+    app->state.gameDeltaTime = (f32)SECONDS_PER_TICK;
+
+    app->gameLib.GameUpdateAndRender(&app->state, GameInvoke::Init, &GlobalGameData);
+
+    f64 totalTime = 0.0;
+    f64 minTickTime = DBL_MAX;
+    f64 maxTickTime = 0.0;
+
+    for (u64 tick = 0; tick < app->ticksToRun; tick++) {
+        app->state.tickCount++;
+        auto tickStartTime = GetTimeStamp();
+        // NOTE: Without fixed timestep the next tick starts right away, so there is no idle time
+        app->state.frameHelpDeadline = app->fixedTimestep ? tickStartTime + SECONDS_PER_TICK - FRAME_HELP_MARGIN : 0.0;
+
+        app->state.localTime = GetLocalTime();
+
+        app->gameLib.GameUpdateAndRender(&app->state, GameInvoke::Update, &GlobalGameData);
+        app->gameLib.GameUpdateAndRender(&app->state, GameInvoke::Render, &GlobalGameData);
+
+        auto tickEndTime = GetTimeStamp();
+        auto tickTime = tickEndTime - tickStartTime;
+        totalTime += tickTime;
+        minTickTime = Min(minTickTime, tickTime);
+        maxTickTime = Max(maxTickTime, tickTime);
+
+        auto timeElapsed = tickTime;
+        if (app->fixedTimestep) {
+            while (timeElapsed < SECONDS_PER_TICK) {
+                auto waitTime = (u32)((SECONDS_PER_TICK - timeElapsed) * 1000.0);
+                if (waitTime) {
+                    LinuxSleep(waitTime);
+                }
+                timeElapsed = GetTimeStamp() - tickStartTime;
+            }
+        }
+
+        // NOTE: Game always simulates with a fixed step, so results do not depend on machine speed
+        app->state.absDeltaTime = (f32)SECONDS_PER_TICK;
+        app->state.fps = (i32)(1.0 / timeElapsed);
+        app->state.ups = app->state.fps;
+        app->state.gameDeltaTime = app->state.absDeltaTime * app->state.gameSpeed;
+    }
+
+    LinuxCompleteAllWork(highQueue);
+    LinuxCompleteAllWork(lowQueue);
+
+    if (app->ticksToRun) {
+        log_print("[Linux] Ticks: %llu, total: %.3f ms, avg: %.3f ms, min: %.3f ms, max: %.3f ms\n", (unsigned long long)app->ticksToRun, totalTime * 1000.0, totalTime * 1000.0 / app->ticksToRun, minTickTime * 1000.0, maxTickTime * 1000.0);
+        for (u32x i = 0; i < array_count(app->scratchArenas); i++) {
+            auto arena = app->scratchArenas[i];
+            log_print("[Linux] Scratch arena %lu: peak %llu kb, committed %llu kb, reserved %llu kb\n", (unsigned long)i, (unsigned long long)(arena->peak / 1024), (unsigned long long)(arena->committed / 1024), (unsigned long long)(arena->size / 1024));
+        }
+    }
+
+    return 0;
+}
+
+#include "WorkQueue.cpp"
@@ -0,0 +1,67 @@
+#pragma once
+#include "Platform.h"
+#include "WorkQueue.h"
+
+#include <pthread.h>
+#include <sched.h>
+#include <semaphore.h>
+
+// NOTE: Headless platform layer. There is no window and no GL context, so the game runs
+// only the simulation part of the frame (chunk streaming, world gen, meshing, entities).
+// Used for profiling and testing the world pipeline on machines without a GPU.
+
+constexpr f64 SECONDS_PER_TICK = 1.0 / 60.0;
+// NOTE: Time left after helping workers at the end of the update. There is nothing to render
+constexpr f64 FRAME_HELP_MARGIN = 0.001;
+
+const u32 NumOfWorkerThreads = 4;
+// NOTE: Main thread has its own deque too
+static_assert(NumOfWorkerThreads + 1 <= MaxWorkQueueThreads);
+
+struct LinuxThreadInfo {
+    u32 index;
+    WorkQueue* lowPriorityQueue;
+    WorkQueue* highPriorityQueue;
+};
+
+typedef void (GameUpdateAndRenderFn)(PlatformState*, GameInvoke, void** data);
+
+struct LinuxLibraryData {
+    inline static const char* LibName = "./flux.so";
+    GameUpdateAndRenderFn* GameUpdateAndRender;
+    void* handle;
+};
+
+// NOTE: Work queue self-check. Foreign threads inject leaf work, the main thread pushes
+// spawner work which pushes leaf work from the pool threads. Every leaf must run exactly once
+struct WorkQueueStressTest {
+    constant u32 ProducerCount = 4;
+    constant u32 JobsPerProducer = 500000;
+    constant u32 SpawnerCount = 1000;
+    constant u32 JobsPerSpawner = 1000;
+    constant u32 JobCount = ProducerCount * JobsPerProducer + SpawnerCount * JobsPerSpawner;
+
+    WorkQueue* queue;
+    u32 volatile* runCounts;
+    u32 volatile producersFinished;
+};
+
+struct LinuxContext {
+    PlatformState state;
+    LinuxLibraryData gameLib;
+    WorkQueue lowPriorityQueue;
+    WorkQueue highPriorityQueue;
+    MemoryArena* scratchArenas[NumOfWorkerThreads + 1];
+    LinuxThreadInfo threadInfo[NumOfWorkerThreads];
+    sem_t workQueueSemaphore;
+    pthread_mutex_t saveThreadMutex;
+    pthread_t saveThread;
+    b32 saveThreadStarted;
+    SaveThreadWorkFn* SaveThreadWork;
+    void* SaveThreadData;
+    u32 saveTimeout;
+    // NOTE: Headless run settings
+    u64 ticksToRun;
+    b32 fixedTimestep;
+    b32 runWorkQueueStressTest;
+};
@@ -13,12 +13,28 @@ inline T Megabytes(T mb) { return mb * static_cast<T>(1024) * static_cast<T>(102
 
 constexpr u64 DefaultAligment = 16;
 
+// NOTE: Arena reserves its whole size up front and commits memory as it grows. Commit and decommit
+// are set by the platform layer which allocated the arena. Arena without them is fully committed
+typedef bool(MemoryArenaCommitFn)(void* memory, uptr size);
+typedef void(MemoryArenaDecommitFn)(void* memory, uptr size);
+
+constexpr uptr MemoryArenaCommitGranularity = 64 * 1024;
+// NOTE: How much committed memory above the offset survives the end of temporary memory
+constexpr uptr MemoryArenaDefaultRetainSize = 4 * 1024 * 1024;
+
 struct alignas(DefaultAligment) MemoryArena
 {
     void* begin;
     uptr offset;
     uptr size;
     uptr free;
+    // NOTE: Bytes from the beginning which are backed by memory
+    uptr committed;
+    // NOTE: Highest offset ever reached
+    uptr peak;
+    uptr retainSize;
+    MemoryArenaCommitFn* Commit;
+    MemoryArenaDecommitFn* Decommit;
     b32 isTemporary;
     i32 tempCount;
 };
@@ -26,9 +42,50 @@ struct alignas(DefaultAligment) MemoryArena
 enum MemoryArenaFlags : u32
 {
     MemoryArenaFlag_None = 0,
-    MemoryArenaFlag_ClearTemp = (1 << 0)
+    MemoryArenaFlag_ClearTemp = (1 << 0),
+    // NOTE: Only reserves the range. Used for sub arenas which commit their memory themselves
+    MemoryArenaFlag_NoCommit = (1 << 1)
 };
 
+inline uptr AlignUp(uptr value, uptr alignment)
+{
+    return (value + alignment - 1) & ~(alignment - 1);
+}
+
+inline uptr AlignDown(uptr value, uptr alignment)
+{
+    return value & ~(alignment - 1);
+}
+
+inline void CommitArenaMemory(MemoryArena* arena, uptr end)
+{
+    if (arena->Commit && end > arena->committed)
+    {
+        uptr newCommitted = AlignUp(end, MemoryArenaCommitGranularity);
+        if (newCommitted > arena->size)
+        {
+            newCommitted = arena->size;
+        }
+        bool committed = arena->Commit((byte*)arena->begin + arena->committed, newCommitted - arena->committed);
+        panic(committed, "[Memory] Failed to commit arena memory");
+        arena->committed = newCommitted;
+    }
+}
+
+// NOTE: Gives back memory above offset + retainSize
+inline void DecommitArenaTail(MemoryArena* arena)
+{
+    if (arena->Decommit)
+    {
+        uptr keep = AlignUp(arena->offset + arena->retainSize, MemoryArenaCommitGranularity);
+        if (arena->committed > keep)
+        {
+            arena->Decommit((byte*)arena->begin + keep, arena->committed - keep);
+            arena->committed = keep;
+        }
+    }
+}
+
 struct TempMemory
 {
     MemoryArena* arena;
@@ -56,6 +113,7 @@ inline void EndTemporaryMemory(TempMemory* frame)
             uptr markOffset = frame->offset;
             arena->free += arena->offset - frame->offset;
             arena->offset = frame->offset;
+            DecommitArenaTail(arena);
         }
         arena->tempCount--;
         assert(arena->tempCount >= 0);
@@ -88,7 +146,7 @@ inline uptr CalculatePadding(uptr offset, uptr alignment)
     return padding;
 }
 
-inline void* PushSizeInternal(MemoryArena* arena, uptr size, uptr aligment)
+inline void* PushSizeInternal(MemoryArena* arena, uptr size, uptr aligment, bool commit = true)
 {
     uptr padding = 0;
     uptr useAligment = 0;
@@ -108,19 +166,35 @@ inline void* PushSizeInternal(MemoryArena* arena, uptr size, uptr aligment)
         padding = CalculatePadding(currentAddress, useAligment);
     }
 
-    // TODO: Grow!
-    assert(size + padding <= arena->free);
+    panic(size + padding <= arena->free, "[Memory] Arena is out of reserved memory");
     uptr nextAdress = (uptr)((byte*)arena->begin + arena->offset + padding);
     assert(nextAdress % useAligment == 0);
+    if (commit)
+    {
+        CommitArenaMemory(arena, arena->offset + padding + size);
+    }
+    else
+    {
+        // NOTE: Range is committed by its owner. Arena never commits it again
+        CommitArenaMemory(arena, arena->offset + padding);
+        if (arena->committed < arena->offset + padding + size)
+        {
+            arena->committed = arena->offset + padding + size;
+        }
+    }
     arena->offset += size + padding;
     arena->free -= size + padding;
+    if (arena->offset > arena->peak)
+    {
+        arena->peak = arena->offset;
+    }
 
     return (void*)nextAdress;
 }
 
 inline void* PushSize(MemoryArena* arena, uptr size, u32 flags = MemoryArenaFlag_ClearTemp, uptr aligment = 0)
 {
-    void* mem = PushSizeInternal(arena, size, aligment);
+    void* mem = PushSizeInternal(arena, size, aligment, !(flags & MemoryArenaFlag_NoCommit));
     if (arena->isTemporary && (flags & MemoryArenaFlag_ClearTemp))
     {
         memset(mem, 0, size);
@@ -131,15 +205,18 @@ inline void* PushSize(MemoryArena* arena, uptr size, u32 flags = MemoryArenaFlag
 inline MemoryArena* AllocateSubArena(MemoryArena* arena, uptr size, bool isTemporary)
 {
     MemoryArena* result = nullptr;
-    uptr chunkSize = size + sizeof(arena);
-    void* chunk = PushSize(arena, chunkSize, DefaultAligment);
-    if (chunk)
+    void* chunk = PushSize(arena, sizeof(MemoryArena), MemoryArenaFlag_None, DefaultAligment);
+    void* body = PushSize(arena, size, MemoryArenaFlag_NoCommit, DefaultAligment);
+    if (chunk && body)
     {
         MemoryArena header = {};
         header.free = size;
         header.size = size;
         header.isTemporary = isTemporary;
-        header.begin = (void*)((byte*)chunk + sizeof(MemoryArena));
+        header.begin = body;
+        header.retainSize = arena->retainSize;
+        header.Commit = arena->Commit;
+        header.Decommit = arena->Decommit;
         memcpy(chunk, &header, sizeof(MemoryArena));
         result = (MemoryArena*)chunk;
     }
@@ -147,3 +224,17 @@ inline MemoryArena* AllocateSubArena(MemoryArena* arena, uptr size, bool isTempo
 }
 
 MemoryArena* AllocateArena(uptr size, bool isTemp);
+
+// NOTE: Allocator API over an arena. Deallocation does nothing, memory is reclaimed
+// when temporary memory of the arena ends
+inline void* ArenaAllocatorAllocate(uptr size, uptr alignment, void* allocatorData)
+{
+    return PushSize((MemoryArena*)allocatorData, size, MemoryArenaFlag_None, alignment);
+}
+
+inline void ArenaAllocatorDeallocate(void* ptr, void* allocatorData) {}
+
+inline Allocator MakeArenaAllocator(MemoryArena* arena)
+{
+    return MakeAllocator(ArenaAllocatorAllocate, ArenaAllocatorDeallocate, arena);
+}
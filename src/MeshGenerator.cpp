@@ -2,19 +2,6 @@
 
 #include "Intrinsics.h"
 
-bool IsBlockOccluder(Chunk* chunk, i32 x, i32 y, i32 z) {
-    bool occluder = false;
-    // NOTE: Assuming blocks on chunk edges always visible
-    if (x < Chunk::Size && y < Chunk::Size && z < Chunk::Size &&
-        x >= 0 && y >= 0 && z >= 0) {
-        auto block = GetBlockValue(chunk, (u32)x, (u32)y, (u32)z);
-        if (block != BlockValue::Empty) {
-            occluder = true;
-        }
-    }
-    return occluder;
-}
-
 void ChunkMesherLock(ChunkMesher* mesher) {
     while (true) {
         if (AtomicCompareExchange(&mesher->freeListLock, 0, 1) == 0) {
@@ -28,24 +15,29 @@ void ChunkMesherUnlock(ChunkMesher* mesher) {
     mesher->freeListLock = 0;
 }
 
-ChunkMeshBlock* GetChunkMeshBlock(ChunkMesher* mesher) {
-    ChunkMeshBlock* block;
+// NOTE: Returns a list of blocks linked with next. The lock is taken once for all of them
+ChunkMeshBlock* GetChunkMeshBlocks(ChunkMesher* mesher, u32 count) {
+    ChunkMeshBlock* blocks = nullptr;
+    u32 blocksToAllocate = count;
     ChunkMesherLock(mesher);
-    if (mesher->freeBlockCount) {
+    while (blocksToAllocate && mesher->freeBlockCount) {
         assert(mesher->freeBlockList);
-        block = mesher->freeBlockList;
+        auto block = mesher->freeBlockList;
         mesher->freeBlockList = block->next;
         mesher->freeBlockCount--;
-    } else {
-        block = (ChunkMeshBlock*)PlatformAlloc(sizeof(ChunkMeshBlock), 0, nullptr);
-        mesher->totalBlockCount++;
+        block->next = blocks;
+        blocks = block;
+        blocksToAllocate--;
     }
+    mesher->totalBlockCount += blocksToAllocate;
     ChunkMesherUnlock(mesher);
 
-    block->next = nullptr;
-    block->prev = nullptr;
-    block->vertexCount = 0;
-    return block;
+    for (u32 i = 0; i < blocksToAllocate; i++) {
+        auto block = (ChunkMeshBlock*)PlatformAlloc(sizeof(ChunkMeshBlock), 0, nullptr);
+        block->next = blocks;
+        blocks = block;
+    }
+    return blocks;
 }
 
 void FreeChunkMeshBlock(ChunkMesher* mesher, ChunkMeshBlock* block) {
@@ -68,91 +60,538 @@ void FreeChunkMesh(ChunkMesher* mesher, ChunkMesh* mesh) {
     mesh->vertexCount = 0;
 }
 
-void PushVertex(ChunkMesher* mesher, ChunkMesh* mesh, v3 v, v3 n, v3 t, u16 terrainIndex) {
-    if (!mesh->begin) {
-        auto newBlock = GetChunkMeshBlock(mesher);
-        mesh->begin = newBlock;
-        mesh->end = newBlock;
+void BeginChunkMeshBuilder(ChunkMeshBuilder* builder, ChunkMesher* mesher, ChunkMesh* mesh, MemoryArena* scratch) {
+    builder->mesher = mesher;
+    builder->mesh = mesh;
+    builder->scratch = scratch;
+    builder->scratchMemory = BeginTemporaryMemory(scratch);
+    builder->first = nullptr;
+    builder->current = nullptr;
+    builder->blockCount = 0;
+}
+
+// NOTE: Moves staged vertices to the mesh and rewinds the scratch arena
+void FlushChunkMeshBuilder(ChunkMeshBuilder* builder) {
+    auto mesh = builder->mesh;
+    auto blocks = builder->blockCount ? GetChunkMeshBlocks(builder->mesher, builder->blockCount) : nullptr;
+    auto staged = builder->first;
+    while (staged) {
+        auto block = blocks;
+        blocks = blocks->next;
+        auto count = staged->vertexCount;
+        block->vertexCount = count;
+        memcpy(block->vertices, staged->vertices, sizeof(block->vertices[0]) * count);
+        block->next = nullptr;
+        block->prev = mesh->begin;
+        if (mesh->begin) {
+            mesh->begin->next = block;
+        } else {
+            mesh->end = block;
+        }
+        mesh->begin = block;
+        mesh->vertexCount += count;
+        staged = staged->next;
+    }
+    assert(!blocks);
+    EndTemporaryMemory(&builder->scratchMemory);
+    builder->scratchMemory = BeginTemporaryMemory(builder->scratch);
+    builder->first = nullptr;
+    builder->current = nullptr;
+    builder->blockCount = 0;
+}
+
+void EndChunkMeshBuilder(ChunkMeshBuilder* builder) {
+    FlushChunkMeshBuilder(builder);
+    EndTemporaryMemory(&builder->scratchMemory);
+}
+
+// NOTE: Box faces in the order of PushBoxFaces flags: up, down, left, right, front, back
+enum BoxFace : u32 {
+    BoxFace_Up = 0, BoxFace_Down, BoxFace_Left, BoxFace_Right, BoxFace_Front, BoxFace_Back, BoxFace_Count
+};
+
+// NOTE: Corners of each face in GetBoxCorners order. Winding is counter-clockwise looking at the face
+constant u32 BoxFaceCorners[BoxFace_Count][4] = {
+    { 3, 2, 5, 7 },
+    { 6, 4, 1, 0 },
+    { 6, 0, 3, 7 },
+    { 1, 4, 5, 2 },
+    { 0, 1, 2, 3 },
+    { 4, 6, 7, 5 },
+};
+
+// NOTE: Direction from the first corner of the face to the second one. Normals are ChunkSideOffsets.
+// Must match the chunk vertex shader
+constant i32 BoxFaceTangents[BoxFace_Count][3] = {
+    { 1, 0, 0 }, { 1, 0, 0 }, { 0, 0, 1 }, { 0, 0, -1 }, { 1, 0, 0 }, { -1, 0, 0 }
+};
+
+// NOTE: Corners are packed vertex positions, see ChunkVertex
+void GetBoxCorners(uv3 min, uv3 max, u32* corners) {
+    corners[0] = PackChunkVertexPosition(min.x, min.y, max.z);
+    corners[1] = PackChunkVertexPosition(max.x, min.y, max.z);
+    corners[2] = PackChunkVertexPosition(max.x, max.y, max.z);
+    corners[3] = PackChunkVertexPosition(min.x, max.y, max.z);
+
+    corners[4] = PackChunkVertexPosition(max.x, min.y, min.z);
+    corners[5] = PackChunkVertexPosition(max.x, max.y, min.z);
+    corners[6] = PackChunkVertexPosition(min.x, min.y, min.z);
+    corners[7] = PackChunkVertexPosition(min.x, max.y, min.z);
+}
+
+void UnpackChunkVertex(ChunkVertex vertex, v3* position, v3* normal, v3* tangent) {
+    u32 x = vertex.packed & ChunkVertex::PositionMask;
+    u32 y = (vertex.packed >> ChunkVertex::PositionBits) & ChunkVertex::PositionMask;
+    u32 z = (vertex.packed >> (ChunkVertex::PositionBits * 2)) & ChunkVertex::PositionMask;
+    u32 face = (vertex.packed >> ChunkVertex::FaceShift) & ChunkVertex::FaceMask;
+    assert(face < BoxFace_Count);
+    *position = V3(x, y, z) * Globals::BlockDim - V3(Globals::BlockHalfDim, Globals::BlockHalfDim, Globals::BlockHalfDim);
+    *normal = V3(IV3(ChunkSideOffsets[face][0], ChunkSideOffsets[face][1], ChunkSideOffsets[face][2]));
+    *tangent = V3(IV3(BoxFaceTangents[face][0], BoxFaceTangents[face][1], BoxFaceTangents[face][2]));
+}
+
+// NOTE: Block size is a multiple of 4, so quads never straddle staging blocks
+static_assert((ChunkMeshBlock::Size % 4) == 0);
+
+// NOTE: Corners are packed positions in face winding order
+void PushQuad(ChunkMeshBuilder* builder, u32 vt0, u32 vt1, u32 vt2, u32 vt3, u32 face, u16 terrainIndex) {
+    auto block = builder->current;
+    if (!block || block->vertexCount == ChunkMeshBlock::Size) {
+        // NOTE: Too many vertices for the scratch arena. Moving what we have to the mesh
+        if (builder->scratch->free < sizeof(ChunkMeshBlock) + DefaultAligment) {
+            FlushChunkMeshBuilder(builder);
+        }
+        block = (ChunkMeshBlock*)PushSize(builder->scratch, sizeof(ChunkMeshBlock), MemoryArenaFlag_None);
+        block->next = nullptr;
+        block->prev = builder->current;
+        block->vertexCount = 0;
+        if (builder->current) {
+            builder->current->next = block;
+        } else {
+            builder->first = block;
+        }
+        builder->current = block;
+        builder->blockCount++;
+    }
+
+    auto at = block->vertexCount;
+    block->vertexCount += 4;
+    u32 faceBits = face << ChunkVertex::FaceShift;
+    block->vertices[at + 0] = ChunkVertex { vt0 | faceBits, terrainIndex };
+    block->vertices[at + 1] = ChunkVertex { vt1 | faceBits, terrainIndex };
+    block->vertices[at + 2] = ChunkVertex { vt2 | faceBits, terrainIndex };
+    block->vertices[at + 3] = ChunkVertex { vt3 | faceBits, terrainIndex };
+}
+
+static_assert((u32)BoxFace_Count == (u32)ChunkSide_Count);
+
+// NOTE: Block past the chunk side is looked up in the border snapshot. Row and bit are the block coords
+// along the side, see GetChunkSideMask
+inline bool IsBorderOccluder(const u32* borders, u32 side, u32 bit, u32 row) {
+    return borders[side * Chunk::Size + row] & (1u << bit);
+}
+
+// NOTE: Blocks are unpacked from the chunk palette to a flat array before meshing.
+// Only one coord might be past the chunk edge
+bool IsBlockOccluder(const BlockValue* blocks, const u32* borders, i32 x, i32 y, i32 z) {
+    constexpr i32 size = Chunk::Size;
+    bool occluder = false;
+    if (x < 0) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Left, y, z);
+    } else if (x >= size) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Right, y, z);
+    } else if (y < 0) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Down, x, z);
+    } else if (y >= size) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Up, x, z);
+    } else if (z < 0) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Back, x, y);
+    } else if (z >= size) {
+        occluder = IsBorderOccluder(borders, ChunkSide_Front, x, y);
+    } else {
+        auto block = blocks[x + size * y + size * size * z];
+        if (block != BlockValue::Empty) {
+            occluder = true;
+        }
+    }
+    return occluder;
+}
+
+// NOTE: Faces of a box which spans blocks from min to max inclusive
+void PushBoxFaces(ChunkMeshBuilder* builder, uv3 minBlock, uv3 maxBlock, BlockValue value, bool up, bool down, bool left, bool right, bool front, bool back) {
+    u32 vt[8];
+    GetBoxCorners(minBlock, maxBlock + UV3(1), vt);
+
+    auto terrainIndex = BlockValueToTerrainIndex(value);
+    bool hidden[BoxFace_Count] = { up, down, left, right, front, back };
+    for (u32 face = 0; face < BoxFace_Count; face++) {
+        if (!hidden[face]) {
+            auto corners = BoxFaceCorners[face];
+            PushQuad(builder, vt[corners[0]], vt[corners[1]], vt[corners[2]], vt[corners[3]], face, terrainIndex);
+        }
     }
-    auto block = mesh->begin;
-    assert(block->vertexCount <= ChunkMeshBlock::Size);
-    if (block->vertexCount == ChunkMeshBlock::Size) {
-        auto newBlock = GetChunkMeshBlock(mesher);
-        mesh->begin = newBlock;
-        block->next = newBlock;
-        newBlock->prev = block;
-        block = newBlock;
+}
+
+void PushBlockFaces(ChunkMeshBuilder* builder, u32 x, u32 y, u32 z, BlockValue value, bool up, bool down, bool left, bool right, bool front, bool back) {
+    PushBoxFaces(builder, UV3(x, y, z), UV3(x, y, z), value, up, down, left, right, front, back);
+}
+
+// NOTE: Every block of a uniform chunk occludes its neighbours inside the chunk,
+// so only faces on the chunk border might be visible. Interior blocks are skipped
+void GenUniformMesh(ChunkMeshBuilder* builder, BlockValue value, const u32* borders) {
+    if (value != BlockValue::Empty) {
+        constexpr u32 last = Chunk::Size - 1;
+        for (u32 z = 0; z < Chunk::Size; z++) {
+            for (u32 y = 0; y < Chunk::Size; y++) {
+                bool borderRow = (z == 0 || z == last || y == 0 || y == last);
+                u32 step = borderRow ? 1 : last;
+                for (u32 x = 0; x < Chunk::Size; x += step) {
+                    bool up = y < last || IsBorderOccluder(borders, ChunkSide_Up, x, z);
+                    bool down = y > 0 || IsBorderOccluder(borders, ChunkSide_Down, x, z);
+                    bool left = x > 0 || IsBorderOccluder(borders, ChunkSide_Left, y, z);
+                    bool right = x < last || IsBorderOccluder(borders, ChunkSide_Right, y, z);
+                    bool front = z < last || IsBorderOccluder(borders, ChunkSide_Front, x, y);
+                    bool back = z > 0 || IsBorderOccluder(borders, ChunkSide_Back, x, y);
+                    PushBlockFaces(builder, x, y, z, value, up, down, left, right, front, back);
+                }
+            }
+        }
     }
+}
+
+// NOTE: Sweeps slices of the chunk along each face direction. Visible faces of a slice go to a mask,
+// then every unvisited face is grown along u while values match and along v while whole rows match
+void GenGreedyMesh(ChunkMeshBuilder* builder, const BlockValue* blocks, const u32* borders, BlockValue* mask) {
+    constexpr u32 size = Chunk::Size;
+    struct FaceDirection { u32 axis; i32 dir; BoxFace face; };
+    const FaceDirection directions[] = {
+        { 1, 1, BoxFace_Up }, { 1, -1, BoxFace_Down }, { 0, -1, BoxFace_Left }, { 0, 1, BoxFace_Right }, { 2, 1, BoxFace_Front }, { 2, -1, BoxFace_Back }
+    };
+    for (u32 dirIndex = 0; dirIndex < array_count(directions); dirIndex++) {
+        auto d = directions[dirIndex];
+        u32 u = (d.axis + 1) % 3;
+        u32 v = (d.axis + 2) % 3;
+        for (u32 slice = 0; slice < size; slice++) {
+            for (u32 j = 0; j < size; j++) {
+                for (u32 i = 0; i < size; i++) {
+                    i32 p[3];
+                    p[d.axis] = (i32)slice;
+                    p[u] = (i32)i;
+                    p[v] = (i32)j;
+                    auto value = blocks[p[0] + size * p[1] + size * size * p[2]];
+                    if (value != BlockValue::Empty) {
+                        p[d.axis] += d.dir;
+                        if (IsBlockOccluder(blocks, borders, p[0], p[1], p[2])) {
+                            value = BlockValue::Empty;
+                        }
+                    }
+                    mask[i + size * j] = value;
+                }
+            }
+
+            for (u32 j = 0; j < size; j++) {
+                for (u32 i = 0; i < size;) {
+                    auto value = mask[i + size * j];
+                    if (value == BlockValue::Empty) {
+                        i++;
+                        continue;
+                    }
+                    u32 width = 1;
+                    while ((i + width) < size && mask[i + width + size * j] == value) {
+                        width++;
+                    }
+                    u32 height = 1;
+                    while ((j + height) < size) {
+                        bool rowMatches = true;
+                        for (u32 k = 0; k < width; k++) {
+                            if (mask[i + k + size * (j + height)] != value) {
+                                rowMatches = false;
+                                break;
+                            }
+                        }
+                        if (!rowMatches) break;
+                        height++;
+                    }
+                    for (u32 h = 0; h < height; h++) {
+                        for (u32 k = 0; k < width; k++) {
+                            mask[i + k + size * (j + h)] = BlockValue::Empty;
+                        }
+                    }
 
-    auto at = block->vertexCount++;
-    block->vertices[at] = v;
-    block->normals[at] = n;
-    block->tangents[at] = t;
-    block->values[at] = (u16)terrainIndex;
-    mesh->vertexCount++;
+                    u32 minBlock[3];
+                    u32 maxBlock[3];
+                    minBlock[d.axis] = slice;
+                    maxBlock[d.axis] = slice;
+                    minBlock[u] = i;
+                    maxBlock[u] = i + width - 1;
+                    minBlock[v] = j;
+                    maxBlock[v] = j + height - 1;
+                    bool hidden[BoxFace_Count] = { true, true, true, true, true, true };
+                    hidden[d.face] = false;
+                    PushBoxFaces(builder, UV3(minBlock[0], minBlock[1], minBlock[2]), UV3(maxBlock[0], maxBlock[1], maxBlock[2]), value,
+                                 hidden[0], hidden[1], hidden[2], hidden[3], hidden[4], hidden[5]);
+                    i += width;
+                }
+            }
+        }
+    }
 }
 
-void PushQuad(ChunkMesher* mesher, ChunkMesh* mesh, v3 vt0, v3 vt1, v3 vt2, v3 vt3, BlockValue value) {
-    v3 n = Cross(vt2 - vt1, vt0 - vt1);
-    v3 t = vt1 - vt0;
-    u16 terrainIndex = BlockValueToTerrainIndex(value);
-    PushVertex(mesher, mesh, vt0, n, t, terrainIndex);
-    PushVertex(mesher, mesh, vt1, n, t, terrainIndex);
-    PushVertex(mesher, mesh, vt2, n, t, terrainIndex);
-    PushVertex(mesher, mesh, vt3, n, t, terrainIndex);
+// NOTE: Chunk::Size is 32, so a line of blocks along an axis is a u32 with a bit per block
+static_assert(Chunk::Size == 32);
+
+// NOTE: x lines are indexed with (y + 32 * z), y lines with (x + 32 * z), z lines with (x + 32 * y)
+struct ChunkLineMasks {
+    constant u32 LineCount = Chunk::Size * Chunk::Size;
+    u32 x[LineCount];
+    u32 y[LineCount];
+    u32 z[LineCount];
+};
+
+// NOTE: Bit j of line i goes to bit i of line j. [ Hacker's Delight 2nd edition, 7-3 ]
+void TransposeBits32(u32* lines) {
+    u32 mask = 0x0000ffff;
+    for (u32 j = 16; j != 0; j >>= 1, mask ^= (mask << j)) {
+        for (u32 k = 0; k < 32; k = ((k | j) + 1) & ~j) {
+            u32 t = ((lines[k] >> j) ^ lines[k | j]) & mask;
+            lines[k] ^= t << j;
+            lines[k | j] ^= t;
+        }
+    }
 }
 
-void GenMesh(ChunkMesher* mesher, Chunk* chunk) {
+// NOTE: Bit per non empty block of a row of 32 blocks
+inline u32 GetBlockRowMask(const BlockValue* row) {
+    u32 emptyMask = 0;
+#if defined(__AVX2__)
+    auto zero = _mm256_setzero_si256();
+    for (u32 i = 0; i < 4; i++) {
+        auto values = _mm256_loadu_si256((const __m256i*)(row + i * 8));
+        auto empty = _mm256_cmpeq_epi32(values, zero);
+        emptyMask |= (u32)_mm256_movemask_ps(_mm256_castsi256_ps(empty)) << (i * 8);
+    }
+#else
+    auto zero = _mm_setzero_si128();
+    for (u32 i = 0; i < 8; i++) {
+        auto values = _mm_loadu_si128((const __m128i*)(row + i * 4));
+        auto empty = _mm_cmpeq_epi32(values, zero);
+        emptyMask |= (u32)_mm_movemask_ps(_mm_castsi128_ps(empty)) << (i * 4);
+    }
+#endif
+    return ~emptyMask;
+}
+
+// NOTE: Face is visible if the next block along the line is empty. Bits shifted in at line ends are zero,
+// faces on chunk borders are culled against neighbor borders afterwards
+void GetLineFaceMasks(const u32* lines, u32* positive, u32* negative) {
+#if defined(__AVX2__)
+    for (u32 i = 0; i < ChunkLineMasks::LineCount; i += 8) {
+        auto line = _mm256_loadu_si256((const __m256i*)(lines + i));
+        _mm256_storeu_si256((__m256i*)(positive + i), _mm256_andnot_si256(_mm256_srli_epi32(line, 1), line));
+        _mm256_storeu_si256((__m256i*)(negative + i), _mm256_andnot_si256(_mm256_slli_epi32(line, 1), line));
+    }
+#else
+    for (u32 i = 0; i < ChunkLineMasks::LineCount; i += 4) {
+        auto line = _mm_loadu_si128((const __m128i*)(lines + i));
+        _mm_storeu_si128((__m128i*)(positive + i), _mm_andnot_si128(_mm_srli_epi32(line, 1), line));
+        _mm_storeu_si128((__m128i*)(negative + i), _mm_andnot_si128(_mm_slli_epi32(line, 1), line));
+    }
+#endif
+}
+
+// NOTE: Side mask has a bit per line crossing the side (see GetChunkSideMask), so filled blocks of the neighbor
+// hide the end face of their lines. Positive faces end at bit 31, negative ones at bit 0
+void CullLineBorderFaces(u32* faceLines, const u32* border, u32 endBit) {
+    for (u32 row = 0; row < Chunk::Size; row++) {
+        auto bits = border[row];
+        while (bits) {
+            u32 line = row * Chunk::Size + CountTrailingZeros(bits);
+            bits &= bits - 1;
+            faceLines[line] &= ~endBit;
+        }
+    }
+}
+
+// NOTE: Same faces as the naive mesher, but visibility is found for whole lines of blocks at once.
+// Occupancy of x lines is built from block rows, y and z lines are its bit transposes.
+// Blocks are null for uniform chunks
+void GenBinaryMesh(ChunkMeshBuilder* builder, const BlockValue* blocks, BlockValue uniformValue, const u32* borders, ChunkLineMasks* lines, u32* faces) {
+    constexpr u32 size = Chunk::Size;
+    constexpr u32 lineCount = ChunkLineMasks::LineCount;
+    if (blocks) {
+        for (u32 z = 0; z < size; z++) {
+            for (u32 y = 0; y < size; y++) {
+                lines->x[y + size * z] = GetBlockRowMask(blocks + size * y + size * size * z);
+            }
+        }
+        for (u32 z = 0; z < size; z++) {
+            memcpy(lines->y + size * z, lines->x + size * z, sizeof(u32) * size);
+            TransposeBits32(lines->y + size * z);
+        }
+        for (u32 y = 0; y < size; y++) {
+            auto zLines = lines->z + size * y;
+            for (u32 z = 0; z < size; z++) {
+                zLines[z] = lines->x[y + size * z];
+            }
+            TransposeBits32(zLines);
+        }
+    } else {
+        u32 line = uniformValue != BlockValue::Empty ? 0xffffffff : 0;
+        for (u32 i = 0; i < lineCount; i++) {
+            lines->x[i] = line;
+            lines->y[i] = line;
+            lines->z[i] = line;
+        }
+    }
+
+    GetLineFaceMasks(lines->y, faces + lineCount * BoxFace_Up, faces + lineCount * BoxFace_Down);
+    GetLineFaceMasks(lines->x, faces + lineCount * BoxFace_Right, faces + lineCount * BoxFace_Left);
+    GetLineFaceMasks(lines->z, faces + lineCount * BoxFace_Front, faces + lineCount * BoxFace_Back);
+    for (u32 face = 0; face < BoxFace_Count; face++) {
+        bool positive = (face == BoxFace_Up || face == BoxFace_Right || face == BoxFace_Front);
+        CullLineBorderFaces(faces + lineCount * face, borders + size * face, positive ? 0x80000000 : 1);
+    }
+
+    u32 corners[8];
+    GetBoxCorners(UV3(0), UV3(1), corners);
+
+    for (u32 face = 0; face < BoxFace_Count; face++) {
+        // NOTE: Corners of a single block. Packed coords of a corner never carry into each other,
+        // so corners of any block are these offsets added to its packed position
+        auto faceCorners = BoxFaceCorners[face];
+        u32 vt0 = corners[faceCorners[0]];
+        u32 vt1 = corners[faceCorners[1]];
+        u32 vt2 = corners[faceCorners[2]];
+        u32 vt3 = corners[faceCorners[3]];
+        auto faceLines = faces + lineCount * face;
+        for (u32 line = 0; line < lineCount; line++) {
+            auto mask = faceLines[line];
+            u32 a = line % size;
+            u32 b = line / size;
+            while (mask) {
+                u32 bit = CountTrailingZeros(mask);
+                mask &= mask - 1;
+                u32 x, y, z;
+                if (face == BoxFace_Up || face == BoxFace_Down) {
+                    x = a; y = bit; z = b;
+                } else if (face == BoxFace_Left || face == BoxFace_Right) {
+                    x = bit; y = a; z = b;
+                } else {
+                    x = a; y = b; z = bit;
+                }
+                auto value = blocks ? blocks[x + size * y + size * size * z] : uniformValue;
+                u32 p = PackChunkVertexPosition(x, y, z);
+                PushQuad(builder, p + vt0, p + vt1, p + vt2, p + vt3, face, BlockValueToTerrainIndex(value));
+            }
+        }
+    }
+}
+
+// NOTE: Uniform chunk is meshed as a single box if every side is either fully hidden by the neighbor or fully visible
+bool GetUniformBoxHiddenFaces(const u32* borders, bool* hidden) {
+    bool result = true;
+    for (u32 face = 0; face < BoxFace_Count; face++) {
+        auto border = borders + Chunk::Size * face;
+        u32 all = 0xffffffff;
+        u32 any = 0;
+        for (u32 row = 0; row < Chunk::Size; row++) {
+            all &= border[row];
+            any |= border[row];
+        }
+        if (any && all != 0xffffffff) {
+            result = false;
+        }
+        hidden[face] = any;
+    }
+    return result;
+}
+
+void GenMesh(ChunkMesher* mesher, Chunk* chunk, MemoryArena* scratch) {
+    GenMesh(mesher, chunk, mesher->mode, scratch);
+}
+
+void GenMesh(ChunkMesher* mesher, Chunk* chunk, ChunkMeshMode mode, MemoryArena* scratch) {
     assert(chunk->primaryMesh);
-    ChunkMesh* mesh = chunk->primaryMesh;
-
-    for (u32 z = 0; z < Chunk::Size; z++) {
-        for (u32 y = 0; y < Chunk::Size; y++) {
-            for (u32 x = 0; x < Chunk::Size; x++) {
-                auto block = GetBlockValueRaw(chunk, x, y, z);
-                if (*block != BlockValue::Empty) {
-                    auto value = *block;
-
-                    bool up = IsBlockOccluder(chunk, (i32)x, ((i32)y) + 1, (i32)z);
-                    bool down = IsBlockOccluder(chunk, (i32)x, ((i32)y) - 1, (i32)z);
-                    bool left = IsBlockOccluder(chunk, ((i32)x) - 1, (i32)y, (i32)z);
-                    bool right = IsBlockOccluder(chunk, ((i32)x) + 1, ((i32)y), (i32)z);
-                    bool front = IsBlockOccluder(chunk, (i32)x, (i32)y, ((i32)z) + 1);
-                    bool back = IsBlockOccluder(chunk, (i32)x, (i32)y, ((i32)z) - 1);
-
-                    v3 offset = V3(x, y, z) * Globals::BlockDim;
-                    v3 min = offset - V3(Globals::BlockHalfDim, Globals::BlockHalfDim, Globals::BlockHalfDim);
-                    v3 max = offset + V3(Globals::BlockHalfDim, Globals::BlockHalfDim, Globals::BlockHalfDim);
-
-                    v3 vt0 = V3(min.x, min.y, max.z);
-                    v3 vt1 = V3(max.x, min.y, max.z);
-                    v3 vt2 = V3(max.x, max.y, max.z);
-                    v3 vt3 = V3(min.x, max.y, max.z);
-
-                    v3 vt4 = V3(max.x, min.y, min.z);
-                    v3 vt5 = V3(max.x, max.y, min.z);
-                    v3 vt6 = V3(min.x, min.y, min.z);
-                    v3 vt7 = V3(min.x, max.y, min.z);
-
-                    if (!up) PushQuad(mesher, mesh, vt3, vt2, vt5, vt7, value);
-                    if (!down) PushQuad(mesher, mesh, vt6, vt4, vt1, vt0, value);
-                    if (!left) PushQuad(mesher, mesh, vt6, vt0, vt3, vt7, value);
-                    if (!right) PushQuad(mesher, mesh, vt1, vt4, vt5, vt2, value);
-                    if (!front) PushQuad(mesher, mesh, vt0, vt1, vt2, vt3, value);
-                    if (!back) PushQuad(mesher, mesh, vt4, vt6, vt7, vt5, value);
+    auto scratchMemory = ScopedTempMemory::Make(scratch);
+    ChunkMeshBuilder builder;
+
+    // NOTE: Meshing work reads the snapshot, neighbors themselves might be edited meanwhile
+    const u32* borders = &chunk->meshBorders[0][0];
+    BlockValue uniformValue;
+    bool uniform = IsChunkUniform(chunk, &uniformValue);
+    bool hidden[BoxFace_Count];
+    if (mode == ChunkMeshMode::Binary) {
+        // NOTE: Before the builder, so flushing it doesn't rewind the blocks and the masks
+        BlockValue* blocks = nullptr;
+        if (!uniform) {
+            blocks = (BlockValue*)PushSize(scratch, sizeof(BlockValue) * Chunk::BlockCount, MemoryArenaFlag_None);
+            UnpackChunkBlocks(chunk, blocks);
+        }
+        auto lines = (ChunkLineMasks*)PushSize(scratch, sizeof(ChunkLineMasks), MemoryArenaFlag_None);
+        auto faces = (u32*)PushSize(scratch, sizeof(u32) * ChunkLineMasks::LineCount * BoxFace_Count, MemoryArenaFlag_None);
+        BeginChunkMeshBuilder(&builder, mesher, chunk->primaryMesh, scratch);
+        GenBinaryMesh(&builder, blocks, uniformValue, borders, lines, faces);
+    } else if (uniform && ((mode != ChunkMeshMode::Greedy) || GetUniformBoxHiddenFaces(borders, hidden))) {
+        BeginChunkMeshBuilder(&builder, mesher, chunk->primaryMesh, scratch);
+        if (mode == ChunkMeshMode::Greedy) {
+            if (uniformValue != BlockValue::Empty) {
+                constexpr u32 last = Chunk::Size - 1;
+                PushBoxFaces(&builder, UV3(0, 0, 0), UV3(last, last, last), uniformValue, hidden[0], hidden[1], hidden[2], hidden[3], hidden[4], hidden[5]);
+            }
+        } else {
+            GenUniformMesh(&builder, uniformValue, borders);
+        }
+    } else if (mode == ChunkMeshMode::Greedy) {
+        // NOTE: Before the builder, so flushing it doesn't rewind the blocks and the mask
+        auto blocks = (BlockValue*)PushSize(scratch, sizeof(BlockValue) * Chunk::BlockCount, MemoryArenaFlag_None);
+        UnpackChunkBlocks(chunk, blocks);
+        auto mask = (BlockValue*)PushSize(scratch, sizeof(BlockValue) * Chunk::Size * Chunk::Size, MemoryArenaFlag_None);
+        BeginChunkMeshBuilder(&builder, mesher, chunk->primaryMesh, scratch);
+        GenGreedyMesh(&builder, blocks, borders, mask);
+    } else {
+        // NOTE: Before the builder, so flushing it doesn't rewind the blocks
+        auto blocks = (BlockValue*)PushSize(scratch, sizeof(BlockValue) * Chunk::BlockCount, MemoryArenaFlag_None);
+        UnpackChunkBlocks(chunk, blocks);
+        BeginChunkMeshBuilder(&builder, mesher, chunk->primaryMesh, scratch);
+
+        for (u32 z = 0; z < Chunk::Size; z++) {
+            for (u32 y = 0; y < Chunk::Size; y++) {
+                for (u32 x = 0; x < Chunk::Size; x++) {
+                    auto value = blocks[x + Chunk::Size * y + Chunk::Size * Chunk::Size * z];
+                    if (value != BlockValue::Empty) {
+                        bool up = IsBlockOccluder(blocks, borders, (i32)x, ((i32)y) + 1, (i32)z);
+                        bool down = IsBlockOccluder(blocks, borders, (i32)x, ((i32)y) - 1, (i32)z);
+                        bool left = IsBlockOccluder(blocks, borders, ((i32)x) - 1, (i32)y, (i32)z);
+                        bool right = IsBlockOccluder(blocks, borders, ((i32)x) + 1, ((i32)y), (i32)z);
+                        bool front = IsBlockOccluder(blocks, borders, (i32)x, (i32)y, ((i32)z) + 1);
+                        bool back = IsBlockOccluder(blocks, borders, (i32)x, (i32)y, ((i32)z) - 1);
+                        PushBlockFaces(&builder, x, y, z, value, up, down, left, right, front, back);
+                    }
                 }
             }
         }
     }
+    EndChunkMeshBuilder(&builder);
 }
 
 
 
-void ChunkMesherWork(void* data0, void* data1, void* data2, u32 threadID) {
+void ChunkMesherWork(void* data0, void* data1, void* data2, u32 threadID, MemoryArena* scratch) {
     auto chunk = (Chunk*)data0;
+    auto handle = data1;
+    if (IsChunkJobCancelled(chunk, handle)) {
+        // NOTE: Might be chained after a cancelled fill which left the chunk in filling state
+        auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)ChunkState::Cancelled);
+        assert(prevState == (u32)ChunkState::Meshing || prevState == (u32)ChunkState::Filling);
+        return;
+    }
     auto mesh = chunk->primaryMesh;
-    GenMesh(mesh->mesher, chunk);
-    if (GetPlatform()->supportsAsyncGPUTransfer) {
+    GenMesh(mesh->mesher, chunk, scratch);
+    if (GetPlatform()->headless) {
+        // NOTE: Nothing to upload to
+        auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)ChunkState::MeshingFinished);
+        assert(prevState == (u32)ChunkState::Meshing);
+    } else if (GetPlatform()->supportsAsyncGPUTransfer) {
         if (chunk->primaryMesh->vertexCount) {
             auto uploaded = UploadToGPU(chunk->primaryMesh, false);
             assert(uploaded);
@@ -169,17 +608,18 @@ bool ScheduleChunkMeshing(GameWorld* world, Chunk* chunk) {
     assert(chunk->primaryMesh);
     assert(chunk->state == ChunkState::Complete);
     bool result = true;
-    auto queue = chunk->priority == ChunkPriority::High ? PlatformHighPriorityQueue : PlatformLowPriorityQueue;
+    auto queue = chunk->remeshingAfterEdit ? PlatformHighPriorityQueue : PlatformLowPriorityQueue;
+    SnapshotChunkMeshBorders(chunk);
     chunk->state = ChunkState::Meshing;
     WriteFence();
-    if (!PlatformPushWork(queue, ChunkMesherWork, chunk, nullptr, nullptr)) {
+    if (!PlatformPushWork(queue, ChunkMesherWork, chunk, GetChunkJobHandle(chunk), nullptr)) {
         chunk->state = ChunkState::Complete;
         result = false;
     }
     return result;
 }
 
-void UploadChunkMeshToGPUWork(void* data0, void* data1, void* data2, u32 threadID) {
+void UploadChunkMeshToGPUWork(void* data0, void* data1, void* data2, u32 threadID, MemoryArena* scratch) {
     auto chunk = (Chunk*)data0;
     auto mesh = chunk->primaryMesh;
     void* ptr = mesh->gpuBufferPtr;
@@ -194,27 +634,6 @@ void UploadChunkMeshToGPUWork(void* data0, void* data1, void* data2, u32 threadI
         block = block->next;
     }
 
-    block = mesh->end;
-    while (block) {
-        memcpy((byte*)ptr + offset, block->normals, sizeof(block->normals[0]) * block->vertexCount);
-        offset += sizeof(block->normals[0]) * block->vertexCount;
-        block = block->next;
-    }
-
-    block = mesh->end;
-    while (block) {
-        memcpy((byte*)ptr + offset, block->tangents, sizeof(block->tangents[0]) * block->vertexCount);
-        offset += sizeof(block->tangents[0]) * block->vertexCount;
-        block = block->next;
-    }
-
-    block = mesh->end;
-    while (block) {
-        memcpy((byte*)ptr + offset, block->values, sizeof(block->values[0]) * block->vertexCount);
-        offset += sizeof(block->values[0]) * block->vertexCount;
-        block = block->next;
-    }
-
     assert(offset == size);
     WriteFence();
     auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)ChunkState::MeshUploadingFinished);
@@ -225,7 +644,7 @@ void ScheduleChunkMeshUpload(Chunk* chunk) {
     assert(chunk->state == ChunkState::WaitsForUpload);
     BeginGPUUpload(chunk->primaryMesh);
     assert(chunk->primaryMesh->gpuBufferPtr);
-    auto queue = chunk->priority == ChunkPriority::High ? PlatformHighPriorityQueue : PlatformLowPriorityQueue;
+    auto queue = chunk->remeshingAfterEdit ? PlatformHighPriorityQueue : PlatformLowPriorityQueue;
     chunk->state = ChunkState::UploadingMesh;
     WriteFence();
     if (!PlatformPushWork(queue, UploadChunkMeshToGPUWork, chunk, nullptr, nullptr)) {
@@ -243,3 +662,116 @@ void CompleteChunkMeshUpload(Chunk* chunk) {
         chunk->state = ChunkState::MeshingFinished;
     }
 }
+
+//
+// NOTE: Benchmark. Run with linux_flux --bench-mesher
+//
+
+// NOTE: Decodes every vertex like the shader does and checks that the quad is a face of a block box:
+// its corners lie in the face plane and the normal and tangent derived from them match the decoded ones
+f32 GetChunkMeshArea(ChunkMesh* mesh) {
+    f32 area = 0.0f;
+    auto block = mesh->end;
+    while (block) {
+        assert((block->vertexCount % 4) == 0);
+        for (u32 i = 0; i < block->vertexCount; i += 4) {
+            v3 p[4];
+            v3 n[4];
+            v3 t[4];
+            for (u32 k = 0; k < 4; k++) {
+                UnpackChunkVertex(block->vertices[i + k], p + k, n + k, t + k);
+                panic(block->vertices[i + k].value == block->vertices[i].value, "[Mesher] Benchmark: quad vertices have different values");
+                panic(n[k] == n[0] && t[k] == t[0], "[Mesher] Benchmark: quad vertices have different faces");
+            }
+            v3 cross = Cross(p[2] - p[1], p[0] - p[1]);
+            f32 quadArea = Length(cross);
+            panic(quadArea > 0.0f, "[Mesher] Benchmark: degenerate quad");
+            panic(Dot(Normalize(cross), n[0]) > 0.999f, "[Mesher] Benchmark: decoded normal doesn't match the winding");
+            panic(Dot(Normalize(p[1] - p[0]), t[0]) > 0.999f, "[Mesher] Benchmark: decoded tangent doesn't match the corners");
+            panic(Abs(Dot(p[3] - p[0], n[0])) < 0.001f, "[Mesher] Benchmark: quad isn't planar");
+            area += quadArea;
+        }
+        block = block->next;
+    }
+    return area;
+}
+
+// NOTE: Sum of quad hashes, so it doesn't depend on the order of quads
+u64 GetChunkMeshQuadChecksum(ChunkMesh* mesh) {
+    u64 checksum = 0;
+    auto block = mesh->end;
+    while (block) {
+        for (u32 i = 0; i < block->vertexCount; i += 4) {
+            u64 hash = block->vertices[i].value;
+            for (u32 k = 0; k < 4; k++) {
+                hash = HashMix64(hash ^ block->vertices[i + k].packed);
+            }
+            checksum += hash;
+        }
+        block = block->next;
+    }
+    return checksum;
+}
+
+// NOTE: Meshes the same generated chunks with every mode. Faces of all modes should cover the same area
+// and binary mode should make exactly the same quads as naive one. Borders come from generated neighbors
+void RunChunkMesherBenchmark(ChunkMesher* mesher, MemoryArena* scratch) {
+    constexpr u32 seed = 293847;
+    constexpr i32 radius = 4;
+    const ChunkMeshMode modes[] = { ChunkMeshMode::Naive, ChunkMeshMode::Greedy, ChunkMeshMode::Binary };
+    f64 times[array_count(modes)] = {};
+    u64 vertexCounts[array_count(modes)] = {};
+
+    WorldGen gen;
+    gen.Init(seed);
+    auto chunk = (Chunk*)PlatformAllocClear(sizeof(Chunk));
+    auto neighbor = (Chunk*)PlatformAllocClear(sizeof(Chunk));
+    panic(chunk && neighbor, "[Mesher] Benchmark: failed to allocate a chunk");
+    ChunkMesh mesh = {};
+    mesh.mesher = mesher;
+    chunk->primaryMesh = &mesh;
+
+    u32 chunkCount = 0;
+    for (i32 z = -radius; z <= radius; z++) {
+        for (i32 y = -1; y <= 0; y++) {
+            for (i32 x = -radius; x <= radius; x++) {
+                chunk->p = IV3(x, y, z);
+                for (u32 side = 0; side < ChunkSide_Count; side++) {
+                    auto offset = ChunkSideOffsets[side];
+                    neighbor->p = chunk->p + IV3(offset[0], offset[1], offset[2]);
+                    GenChunk(&gen, neighbor, scratch);
+                    GetChunkSideMask(neighbor, side ^ 1, chunk->meshBorders[side]);
+                    FreeChunkBlockStorage(neighbor);
+                }
+                GenChunk(&gen, chunk, scratch);
+                f32 naiveArea = 0.0f;
+                u64 naiveChecksum = 0;
+                for (u32 m = 0; m < array_count(modes); m++) {
+                    auto beginTime = PlatformGetTimeStamp();
+                    GenMesh(mesher, chunk, modes[m], scratch);
+                    times[m] += PlatformGetTimeStamp() - beginTime;
+                    vertexCounts[m] += mesh.vertexCount;
+                    auto area = GetChunkMeshArea(&mesh);
+                    if (m == 0) {
+                        naiveArea = area;
+                        naiveChecksum = GetChunkMeshQuadChecksum(&mesh);
+                    } else {
+                        if (modes[m] == ChunkMeshMode::Binary) {
+                            panic(GetChunkMeshQuadChecksum(&mesh) == naiveChecksum, "[Mesher] Benchmark: binary mesh of chunk (%ld, %ld, %ld) differs from naive one", x, y, z);
+                        }
+                        panic(Abs(area - naiveArea) < 0.5f, "[Mesher] Benchmark: %s mesh of chunk (%ld, %ld, %ld) covers %f instead of %f", ToString(modes[m]), x, y, z, area, naiveArea);
+                    }
+                    FreeChunkMesh(mesher, &mesh);
+                }
+                FreeChunkBlockStorage(chunk);
+                chunkCount++;
+            }
+        }
+    }
+    PlatformFree(chunk, nullptr);
+    PlatformFree(neighbor, nullptr);
+
+    for (u32 m = 0; m < array_count(modes); m++) {
+        log_print("[Mesher] %-6s %lu chunks: %9llu vertices (%7.1f per chunk), %7.3f ms per chunk\n", ToString(modes[m]), chunkCount, vertexCounts[m], (f64)vertexCounts[m] / chunkCount, times[m] * 1000.0 / chunkCount);
+    }
+}
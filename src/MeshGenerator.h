@@ -5,21 +5,44 @@
 
 struct Chunk;
 
+// NOTE: Packed chunk vertex. Position is a block corner in chunk coords (0..32, 6 bits per axis).
+// Faces are axis aligned, so normal and tangent come from the face (BoxFace, 3 bits).
+// Corner (0, 0, 0) is at -BlockHalfDim, same as the unpacked position of the first block corner
+//
+// packed: x | y << 6 | z << 12 | face << 18, bits 21..31 are unused
+// value: terrain texture index
+struct ChunkVertex {
+    static const u32 PositionBits = 6;
+    static const u32 PositionMask = (1 << PositionBits) - 1;
+    static const u32 FaceShift = PositionBits * 3;
+    static const u32 FaceMask = 0x7;
+
+    u32 packed;
+    u32 value;
+};
+
+static_assert(sizeof(ChunkVertex) == 8);
+
+inline u32 PackChunkVertexPosition(u32 x, u32 y, u32 z) {
+    assert(x <= ChunkVertex::PositionMask && y <= ChunkVertex::PositionMask && z <= ChunkVertex::PositionMask);
+    return x | (y << ChunkVertex::PositionBits) | (z << (ChunkVertex::PositionBits * 2));
+}
+
+// NOTE: Decoding as the chunk vertex shader does it, so meshes can be checked on the CPU
+void UnpackChunkVertex(ChunkVertex vertex, v3* position, v3* normal, v3* tangent);
+
 struct ChunkMeshBlock {
     static const u32 Size = 4096;
     ChunkMeshBlock* next;
     ChunkMeshBlock* prev;
     u32 vertexCount;
-    v3 vertices[Size];
-    v3 normals[Size];
-    v3 tangents[Size];
-    u16 values[Size];
+    ChunkVertex vertices[Size];
 };
 
 struct ChunkMesher;
 
 struct ChunkMesh {
-    static const u32 VertexSize = sizeof(v3) + sizeof(v3) + sizeof(v3) + sizeof(u16);
+    static const u32 VertexSize = sizeof(ChunkVertex);
 
     ChunkMeshBlock* begin;
     ChunkMeshBlock* end;
@@ -33,16 +56,49 @@ struct ChunkMesh {
     Chunk* chunk;
 };
 
+// NOTE: Greedy mode merges coplanar faces of the same block value into rectangles. Terrain texture
+// coordinates come from the position, so merged faces tile the texture like separate ones.
+// Binary mode makes the same faces as naive one, but finds them with bit masks of whole block lines
+enum struct ChunkMeshMode : u32 {
+    Naive = 0, Greedy, Binary
+};
+
+const char* ToString(ChunkMeshMode mode) {
+    switch (mode) {
+    case ChunkMeshMode::Naive: { return "naive"; } break;
+    case ChunkMeshMode::Greedy: { return "greedy"; } break;
+    case ChunkMeshMode::Binary: { return "binary"; } break;
+    invalid_default();
+    }
+    return nullptr;
+}
+
 struct ChunkMesher {
+    // NOTE: Read by meshing work once per chunk. Switching it affects chunks meshed afterwards
+    volatile ChunkMeshMode mode;
     u32 totalBlockCount;
     u32 freeBlockCount;
     ChunkMeshBlock* freeBlockList;
     volatile u32 freeListLock;
 };
 
-void GenMesh(ChunkMesher* mesher, Chunk* chunk);
+// NOTE: Mesh is built in scratch memory, then moved to mesher blocks at once
+struct ChunkMeshBuilder {
+    ChunkMesher* mesher;
+    ChunkMesh* mesh;
+    MemoryArena* scratch;
+    TempMemory scratchMemory;
+    ChunkMeshBlock* first;
+    ChunkMeshBlock* current;
+    u32 blockCount;
+};
+
+void GenMesh(ChunkMesher* mesher, Chunk* chunk, MemoryArena* scratch);
+void GenMesh(ChunkMesher* mesher, Chunk* chunk, ChunkMeshMode mode, MemoryArena* scratch);
 void FreeChunkMesh(ChunkMesher* mesher, ChunkMesh* mesh);
 
 bool ScheduleChunkMeshing(GameWorld* world, Chunk* chunk);
 void ScheduleChunkMeshUpload(Chunk* chunk);
 void CompleteChunkMeshUpload(Chunk* chunk);
+
+void RunChunkMesherBenchmark(ChunkMesher* mesher, MemoryArena* scratch);
@@ -90,9 +90,47 @@ typedef void(DeallocatePagesFn)(void* memory, uptr size);
 
 // Work queue API
 struct WorkQueue;
-typedef void(WorkFn)(void* data0, void* data1, void* data2, u32 threadIndex);
+// NOTE: Scratch is the arena of the thread which runs the work. It is reset when the work is done
+typedef void(WorkFn)(void* data0, void* data1, void* data2, u32 threadIndex, MemoryArena* scratch);
 typedef b32(PushWorkFn)(WorkQueue* queue, WorkFn* fn, void* data0, void* data1, void* data2);
 typedef void(CompleteAllWorkFn)(WorkQueue* queue);
+// NOTE: Scratch arena of the calling thread (main or worker). Use it under temporary memory
+typedef MemoryArena*(GetScratchArenaFn)();
+
+// NOTE: Counts unfinished work pushed with it. When the counter drops to zero its successor
+// is pushed by the thread which finished the last piece of work, so dependent work chains
+// on workers without waiting for the main thread.
+// Counter is created holding one reference (see BeginWorkCounter) so the successor can't launch
+// while work is still being pushed. The reference is dropped by ReleaseWorkCounter.
+struct WorkCounter {
+    u32 volatile value;
+    WorkQueue* successorQueue;
+    WorkFn* successor;
+    void* successorData0;
+    void* successorData1;
+    void* successorData2;
+};
+
+inline void BeginWorkCounter(WorkCounter* counter, WorkQueue* successorQueue, WorkFn* successor, void* data0, void* data1, void* data2) {
+    counter->value = 1;
+    counter->successorQueue = successorQueue;
+    counter->successor = successor;
+    counter->successorData0 = data0;
+    counter->successorData1 = data1;
+    counter->successorData2 = data2;
+}
+
+typedef b32(PushWorkWithCounterFn)(WorkQueue* queue, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2);
+typedef void(ReleaseWorkCounterFn)(WorkCounter* counter);
+
+// NOTE: Waiting is over when condition returns true
+typedef b32(HelpConditionFn)(void* data);
+// NOTE: Calling thread (main or worker) runs queued work instead of idling until the condition
+// is met or the deadline (in GetTimeStamp time) passes. Zero deadline means no deadline.
+// Without a condition it returns as soon as there is no work left. Returns true if the condition was met
+typedef b32(HelpUntilFn)(HelpConditionFn* condition, void* data, f64 deadline);
+// NOTE: Helps until the counter drops to zero
+typedef void(WaitForWorkCounterFn)(WorkCounter* counter);
 
 typedef void(SaveThreadWorkFn)(void* data);
 typedef void(SetSaveThreadWorkFn)(SaveThreadWorkFn* func, void* data, u32 timeoutMs);
@@ -178,7 +216,12 @@ struct PlatformCalls
 
     // Work queue
     PushWorkFn* PushWork;
+    PushWorkWithCounterFn* PushWorkWithCounter;
+    ReleaseWorkCounterFn* ReleaseWorkCounter;
     CompleteAllWorkFn* CompleteAllWork;
+    HelpUntilFn* HelpUntil;
+    WaitForWorkCounterFn* WaitForWorkCounter;
+    GetScratchArenaFn* GetScratchArena;
     SetSaveThreadWorkFn* SetSaveThreadWork;
 
     GetTimeStampFn* GetTimeStamp;
@@ -268,6 +311,13 @@ struct PlatformState
 {
     PlatformCalls functions;
     OpenGL* gl;
+    // NOTE: Set by platform layers without a window and a real GL context.
+    // Game skips asset loading, rendering and mesh uploads in that case
+    b32 headless;
+    // NOTE: Game runs hash map benchmark on init
+    b32 runHashMapBenchmark;
+    // NOTE: Game runs chunk mesher benchmark on init
+    b32 runMesherBenchmark;
     volatile b32 supportsAsyncGPUTransfer;
     WorkQueue* lowPriorityQueue;
     WorkQueue* highPriorityQueue;
@@ -275,6 +325,8 @@ struct PlatformState
     InputMode inputMode;
     InputState input;
     u64 tickCount;
+    // NOTE: Main thread helps workers until this time at the end of the update. Zero if it shouldn't
+    f64 frameHelpDeadline;
     i32 fps;
     i32 ups;
     f32 gameSpeed;
@@ -302,27 +302,6 @@ bool UploadToGPU(ChunkMesh* mesh, bool async) {
             block = block->next;
         }
 
-        block = mesh->end;
-        while (block) {
-            memcpy((byte*)ptr + offset, block->normals, sizeof(block->normals[0]) * block->vertexCount);
-            offset += sizeof(block->normals[0]) * block->vertexCount;
-            block = block->next;
-        }
-
-        block = mesh->end;
-        while (block) {
-            memcpy((byte*)ptr + offset, block->tangents, sizeof(block->tangents[0]) * block->vertexCount);
-            offset += sizeof(block->tangents[0]) * block->vertexCount;
-            block = block->next;
-        }
-
-        block = mesh->end;
-        while (block) {
-            memcpy((byte*)ptr + offset, block->values, sizeof(block->values[0]) * block->vertexCount);
-            offset += sizeof(block->values[0]) * block->vertexCount;
-            block = block->next;
-        }
-
         assert(offset == size);
 
         glUnmapBuffer(GL_ARRAY_BUFFER);
@@ -1199,19 +1178,11 @@ void MainPass(Renderer* renderer, RenderGroup* group) {
 
                     glBindBuffer(GL_ARRAY_BUFFER, mesh->gpuHandle);
 
-                    glEnableVertexAttribArray(ChunkShader::Position);
-                    glEnableVertexAttribArray(ChunkShader::Normal);
-                    glEnableVertexAttribArray(ChunkShader::Tangent);
+                    glEnableVertexAttribArray(ChunkShader::PackedVertex);
                     glEnableVertexAttribArray(ChunkShader::BlockValue);
 
-                    uptr normalsOffset = mesh->vertexCount * sizeof(v3);
-                    uptr tangentsOffset = normalsOffset + mesh->vertexCount * sizeof(v3);
-                    uptr valuesOffset = tangentsOffset + mesh->vertexCount * sizeof(v3);
-
-                    glVertexAttribPointer(ChunkShader::Position, 3, GL_FLOAT, GL_FALSE, 0, 0);
-                    glVertexAttribPointer(ChunkShader::Normal, 3, GL_FLOAT, GL_FALSE, 0, (void*)normalsOffset);
-                    glVertexAttribPointer(ChunkShader::Tangent, 3, GL_FLOAT, GL_FALSE, 0, (void*)tangentsOffset);
-                    glVertexAttribIPointer(ChunkShader::BlockValue, 1, GL_UNSIGNED_SHORT, 0, (void*)valuesOffset);
+                    glVertexAttribIPointer(ChunkShader::PackedVertex, 1, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)offset_of(ChunkVertex, packed));
+                    glVertexAttribIPointer(ChunkShader::BlockValue, 1, GL_UNSIGNED_INT, sizeof(ChunkVertex), (void*)offset_of(ChunkVertex, value));
 
                     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, renderer->chunkIndexBufferHandle);
                     // TODO: Look for glDrawElementsInstancedBaseInstance
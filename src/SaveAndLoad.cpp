@@ -34,7 +34,7 @@ Entity* DeserializeEntityV1(GameWorld* world, EntityHeaderV1* header) {
     auto info = GetEntityInfo(header->type);
     assert(info->Create);
     Entity* entity = nullptr;
-    switch (header->kind) {
+    switch ((EntityKind)header->kind) {
     case EntityKind::Spatial: {
         auto p = WorldPos::Make(header->spatial.pBlock, header->spatial.pOffset);
         entity = RestoreSpatialEntity(world, header->id, header->type, header->flags, p, header->spatial.velocity, header->spatial.scale, header->spatial.acceleration, header->spatial.friction);
@@ -50,12 +50,24 @@ Entity* DeserializeEntityV1(GameWorld* world, EntityHeaderV1* header) {
 bool SaveWorldData(GameWorld* world) {
     wchar_t nameBuffer[256];
     swprintf_s(nameBuffer, 128, L"%hs\\%hs.world", world->name, world->name);
-    WorldFile data {};
-    data.magic = WorldFile::MagicValue;
-    data.version = WorldFile::LatestVersion;
-    data.entitySerialCount = world->entitySerialCount;
+    auto table = &world->entityTable;
+    auto scratch = PlatformGetScratchArena();
+    auto scratchMemory = ScopedTempMemory::Make(scratch);
+    auto fileSize = sizeof(WorldFile) + (sizeof(u32) + sizeof(u8)) * table->slotCount;
+    auto data = (WorldFile*)PushSize(scratch, fileSize, MemoryArenaFlag_None);
+    ClearMemory(data);
+    data->magic = WorldFile::MagicValue;
+    data->version = WorldFile::LatestVersion;
+    data->entitySerialCount = world->entitySerialCount;
+    data->entitySlotCount = table->slotCount;
+    auto generations = (u32*)(data + 1);
+    auto used = (u8*)(generations + table->slotCount);
+    for (u32 i = 0; i < table->slotCount; i++) {
+        generations[i] = table->slots[i].generation;
+        used[i] = table->slots[i].nextFree == EntityTable::SlotUsed;
+    }
 
-    auto writeResult = PlatformDebugWriteFile(nameBuffer, &data, sizeof(data));
+    auto writeResult = PlatformDebugWriteFile(nameBuffer, data, (u32)fileSize);
 
     return writeResult;
 }
@@ -65,12 +77,24 @@ bool LoadWorldData(GameWorld* world) {
     wchar_t nameBuffer[256];
     swprintf_s(nameBuffer, 128, L"%hs\\%hs.world", world->name, world->name);
     auto fileSize = PlatformDebugGetFileSize(nameBuffer);
-    if (fileSize == sizeof(WorldFile)) {
-        WorldFile data;
-        auto readResult = PlatformDebugReadFile(&data, sizeof(data), nameBuffer);
-        if (readResult == sizeof(data)) {
-            if (data.magic == WorldFile::MagicValue && data.version == WorldFile::LatestVersion) {
-                world->entitySerialCount = data.entitySerialCount;
+    auto v1Size = offset_of(WorldFile, entitySlotCount);
+    if (fileSize >= v1Size) {
+        auto scratch = PlatformGetScratchArena();
+        auto scratchMemory = ScopedTempMemory::Make(scratch);
+        auto data = (WorldFile*)PushSize(scratch, Max((uptr)fileSize, sizeof(WorldFile)), MemoryArenaFlag_None);
+        auto readResult = PlatformDebugReadFile(data, (u32)fileSize, nameBuffer);
+        if (readResult == fileSize && data->magic == WorldFile::MagicValue) {
+            auto table = &world->entityTable;
+            if (data->version == 1 && fileSize == v1Size) {
+                // NOTE: Ids were serial numbers back then
+                world->entitySerialCount = data->entitySerialCount;
+                EntityTableAcquireSerialIDs(table, data->entitySerialCount);
+                result = true;
+            } else if (data->version == WorldFile::LatestVersion && fileSize >= sizeof(WorldFile) && fileSize == sizeof(WorldFile) + (sizeof(u32) + sizeof(u8)) * (uptr)data->entitySlotCount) {
+                world->entitySerialCount = data->entitySerialCount;
+                auto generations = (u32*)(data + 1);
+                auto used = (u8*)(generations + data->entitySlotCount);
+                EntityTableRestore(table, data->entitySlotCount, generations, used);
                 result = true;
             }
         }
@@ -78,23 +102,31 @@ bool LoadWorldData(GameWorld* world) {
     return result;
 }
 
-bool SaveChunk(Chunk* chunk) {
+bool SaveChunk(Chunk* chunk, MemoryArena* scratch) {
     bool result = false;
     auto world = GetWorld();
     wchar_t nameBuffer[256];
     swprintf_s(nameBuffer, 128, L"%hs\\%ld.%ld.%ld.chunk", world->name, chunk->p.x, chunk->p.y, chunk->p.z);
-    auto dataSize = Chunk::Size * Chunk::Size * Chunk::Size * sizeof(BlockValue);
-    auto blockDataWriteResult = PlatformDebugWriteFile(nameBuffer, chunk->blocks, (u32)dataSize);
+    // NOTE: File keeps flat block values, palette is only an in-memory representation.
+    // Uniform chunk is saved as a single value, loader tells them apart by the file size
+    auto scratchMemory = ScopedTempMemory::Make(scratch);
+    BlockValue uniformValue;
+    bool blockDataWriteResult = false;
+    if (IsChunkUniform(chunk, &uniformValue)) {
+        blockDataWriteResult = PlatformDebugWriteFile(nameBuffer, &uniformValue, sizeof(uniformValue));
+    } else {
+        auto dataSize = Chunk::BlockCount * sizeof(BlockValue);
+        auto blocks = (BlockValue*)PushSize(scratch, dataSize, MemoryArenaFlag_None);
+        UnpackChunkBlocks(chunk, blocks);
+        blockDataWriteResult = PlatformDebugWriteFile(nameBuffer, blocks, (u32)dataSize);
+    }
+    result = blockDataWriteResult;
 
     if (blockDataWriteResult && chunk->entityStorage.count) {
         BinaryBlob headerTable {};
         BinaryBlob entityData {};
-        BinaryBlob::Init(&headerTable, MakeAllocator(PlatformAlloc, PlatformFree, nullptr));
-        BinaryBlob::Init(&entityData, MakeAllocator(PlatformAlloc, PlatformFree, nullptr));
-        defer {
-            headerTable.Destroy();
-            entityData.Destroy();
-        };
+        BinaryBlob::Init(&headerTable, MakeArenaAllocator(scratch));
+        BinaryBlob::Init(&entityData, MakeArenaAllocator(scratch));
 
         auto fileHeader = (EntityFileHeader*)headerTable.Write(sizeof(EntityFileHeader));
         fileHeader->magic = EntityFileHeader::MagicValue;
@@ -123,8 +155,6 @@ bool SaveChunk(Chunk* chunk) {
             }
         });
 
-        result = true;
-
         if (headerTable.at) {
             swprintf_s(nameBuffer, 128, L"%hs\\%ld.%ld.%ld.entities", world->name, chunk->p.x, chunk->p.y, chunk->p.z);
             auto entityHeadersWriteResult = PlatformDebugWriteFile(nameBuffer, headerTable.data, (u32)headerTable.at);
@@ -149,9 +179,25 @@ bool TryLoadChunk(Chunk* chunk) {
     auto world = GetWorld();
     wchar_t nameBuffer[256];
     swprintf_s(nameBuffer, 128, L"%hs\\%ld.%ld.%ld.chunk", world->name, chunk->p.x, chunk->p.y, chunk->p.z);
-    auto dataSize = Chunk::Size * Chunk::Size * Chunk::Size * sizeof(BlockValue);
-    auto blockDataLoadResult = PlatformDebugReadFile(chunk->blocks, (u32)dataSize, nameBuffer);
-    return blockDataLoadResult;
+    auto dataSize = Chunk::BlockCount * sizeof(BlockValue);
+    auto fileSize = PlatformDebugGetFileSize(nameBuffer);
+    if (fileSize == sizeof(BlockValue)) {
+        BlockValue uniformValue;
+        if (PlatformDebugReadFile(&uniformValue, sizeof(uniformValue), nameBuffer) == sizeof(uniformValue)) {
+            SetChunkBlocksUniform(chunk, uniformValue);
+            result = true;
+        }
+    } else if (fileSize == dataSize) {
+        auto scratch = PlatformGetScratchArena();
+        auto scratchMemory = ScopedTempMemory::Make(scratch);
+        auto blocks = (BlockValue*)PushSize(scratch, dataSize, MemoryArenaFlag_None);
+        auto blockDataLoadResult = PlatformDebugReadFile(blocks, (u32)dataSize, nameBuffer);
+        if (blockDataLoadResult == dataSize) {
+            PackChunkBlocks(chunk, blocks);
+            result = true;
+        }
+    }
+    return result;
 }
 
 void TryLoadEntities(Chunk* chunk) {
@@ -161,9 +207,9 @@ void TryLoadEntities(Chunk* chunk) {
     swprintf_s(nameBuffer, 128, L"%hs\\%ld.%ld.%ld.entities", world->name, chunk->p.x, chunk->p.y, chunk->p.z);
     auto headersSize = PlatformDebugGetFileSize(nameBuffer);
     if (headersSize) {
-        auto data = PlatformAlloc(headersSize, 0, nullptr);
-        defer { PlatformFree(data, nullptr); };
-        assert(data);
+        auto scratch = PlatformGetScratchArena();
+        auto scratchMemory = ScopedTempMemory::Make(scratch);
+        auto data = PushSize(scratch, headersSize, MemoryArenaFlag_None);
         auto readHeadersSize = PlatformDebugReadFile(data, (u32)headersSize, nameBuffer);
         if (readHeadersSize == headersSize) {
             // Trying to find and read data file
@@ -172,8 +218,7 @@ void TryLoadEntities(Chunk* chunk) {
             swprintf_s(nameBuffer, 128, L"%hs\\%ld.%ld.%ld.data", world->name, chunk->p.x, chunk->p.y, chunk->p.z);
             auto dataSize = PlatformDebugGetFileSize(nameBuffer);
             if (dataSize) {
-                auto entityDataBlob = PlatformAlloc(dataSize, 0, nullptr);
-                assert(entityDataBlob);
+                auto entityDataBlob = PushSize(scratch, dataSize, MemoryArenaFlag_None);
                 auto readDataSize = PlatformDebugReadFile(entityDataBlob, (u32)dataSize, nameBuffer);
                 if (readDataSize == dataSize) {
                     entityData = entityDataBlob;
@@ -214,9 +259,6 @@ void TryLoadEntities(Chunk* chunk) {
                     }
                 }
             }
-            if (entityData) {
-                PlatformFree(entityData, nullptr);
-            }
         }
     }
 }
@@ -230,7 +272,7 @@ bool SaveWorld(GameWorld* world) {
         ForEachSimChunk(pool, [&](Chunk* chunk) {
             auto chunkIsCurrentlySaving = AtomicLoad(&chunk->saving);
             if (!chunkIsCurrentlySaving && ((chunk->lastSaveTick < chunk->lastModificationTick) || chunk->simPropagationCount)) {
-                auto saved = SaveChunk(chunk);
+                auto saved = SaveChunk(chunk, PlatformGetScratchArena());
                 if (!saved) {
                     result = false;
                 } else {
@@ -239,8 +281,6 @@ bool SaveWorld(GameWorld* world) {
             }
         });
     }
-    while (AtomicLoad(&pool->pendingSavesCount)) {
-        log_print("[Save] Spin-lock waiting for all chunks to be saved. %lu in process", pool->pendingSavesCount);
-    }
+    PlatformWaitForWorkCounter(&pool->saveWorkCounter);
     return result;
 }
@@ -4,13 +4,18 @@
 
 struct Chunk;
 struct GameWorld;
+struct MemoryArena;
 
+// NOTE: Version 1 file ends after entitySerialCount. Version 2 is followed by entity table slots:
+// u32 generations[entitySlotCount] then u8 used[entitySlotCount]
 struct WorldFile {
     constant u32 MagicValue = 0xcabccabc;
-    constant u32 LatestVersion = 1;
+    constant u32 LatestVersion = 2;
     u32 magic;
     u32 version;
     u64 entitySerialCount;
+    u32 entitySlotCount;
+    u32 _reserved;
 };
 
 struct EntityFileHeader {
@@ -49,7 +54,8 @@ struct EntityHeaderV1 {
 
 void SaveThreadWork(void* data);
 
-bool SaveChunk(Chunk* chunk);
+// NOTE: Serialization temporaries go to scratch arena
+bool SaveChunk(Chunk* chunk, MemoryArena* scratch);
 bool TryLoadChunk(Chunk* chunk);
 void TryLoadEntities(Chunk* chunk);
 
@@ -36,10 +36,8 @@ void UniformBufferUnmap(UniformBuffer<T, Binding>* buffer);
 
 struct ChunkShader {
     static constexpr u32 OffsetUniformLocation = 0;
-    static constexpr u32 Position = 0;
-    static constexpr u32 Normal = 1;
-    static constexpr u32 Tangent = 2;
-    static constexpr u32 BlockValue = 3;
+    static constexpr u32 PackedVertex = 0;
+    static constexpr u32 BlockValue = 1;
     static constexpr u32 TerrainAtlasSampler = 0;
     static constexpr u32 ShadowMapSampler = 9;
 };
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <errno.h>
+
 bool MatchStrings(const char* a, const char* b) {
     bool result = true;
     while(*a) {
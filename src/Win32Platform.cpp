@@ -27,6 +27,8 @@ static Win32Context GlobalContext = {};
 static bool GlobalRunning = true;
 static LARGE_INTEGER GlobalPerformanceFrequency = {};
 static void* GlobalGameData = 0;
+// NOTE: Index of the work queue deque owned by the current thread
+static thread_local u32 GlobalThreadIndex = WorkQueueForeignThread;
 
 // TODO: Logger
 void Logger(void* data, const char* fmt, va_list* args) {
@@ -1173,51 +1175,48 @@ void ImguiFreeWrapper(void* ptr, void*_) { Deallocate(ptr, nullptr); }
 #define glClearColor gl_function(glClearColor)
 #define glClear gl_function(glClear)
 
-b32 Win32PushWork(WorkQueue* queue, WorkFn* fn, void* data0, void* data1, void* data2) {
-    bool result = false;
-    auto nextEntry = (queue->end + 1) % array_count(queue->queue);
-    if (nextEntry != queue->begin) {
-        auto entry = queue->queue + queue->end;
-        entry->function = fn;
-        entry->data0 = data0;
-        entry->data1 = data1;
-        entry->data2 = data2;
-        queue->pendingWorkCount++;
-        WriteFence();
-        // TODO: Maybe it should be atomic?
-        queue->end = nextEntry;
-        ReleaseSemaphore(GlobalContext.workQueueSemaphore, 1, nullptr);
-        result = true;
-    }
-    return result;
+void Win32SignalWorkers() {
+    // NOTE: Semaphore maximum count is the number of workers, so it fails silently when everyone is already awake
+    ReleaseSemaphore(GlobalContext.workQueueSemaphore, 1, nullptr);
 }
 
-bool Win32DoWorkerWork(WorkQueue* queue, u32 threadIndex) {
-    bool result = false;
-    auto oldBegin = queue->begin;
-    auto newBegin = (oldBegin + 1) % array_count(queue->queue);
-    // TODO: new? or old?
-    if (oldBegin != queue->end) {
-        u32 index = InterlockedCompareExchange(((LONG volatile*)&queue->begin), newBegin, oldBegin);
-        if (index == oldBegin) {
-            auto entry = queue->queue + index;
-            if (entry->function) {
-                entry->function(entry->data0, entry->data1, entry->data2,  threadIndex);
-            }
-            InterlockedIncrement((LONG volatile*)&queue->completedWorkCount);
-            result = true;
-        }
+b32 Win32PushWorkWithCounter(WorkQueue* queue, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2) {
+    b32 result = true;
+    if (GlobalThreadIndex != WorkQueueForeignThread) {
+        WorkQueuePush(queue, GlobalThreadIndex, counter, fn, data0, data1, data2);
+    } else {
+        // NOTE: Threads outside of the pool don't have deques
+        result = WorkQueueInject(queue, counter, fn, data0, data1, data2);
     }
     return result;
 }
 
+b32 Win32PushWork(WorkQueue* queue, WorkFn* fn, void* data0, void* data1, void* data2) {
+    return Win32PushWorkWithCounter(queue, nullptr, fn, data0, data1, data2);
+}
+
+void Win32ReleaseWorkCounter(WorkCounter* counter) {
+    WorkCounterRelease(counter, GlobalThreadIndex);
+}
+
+b32 Win32HelpUntil(HelpConditionFn* condition, void* data, f64 deadline) {
+    panic(GlobalThreadIndex != WorkQueueForeignThread, "[Win32] Only main and worker threads can help with work");
+    WorkQueue* queues[] = { &GlobalContext.highPriorityQueue, &GlobalContext.lowPriorityQueue };
+    return WorkQueuesHelpUntil(queues, array_count(queues), GlobalThreadIndex, condition, data, deadline);
+}
+
+void Win32WaitForWorkCounter(WorkCounter* counter) {
+    Win32HelpUntil(WorkCounterIsZeroCondition, counter, 0.0);
+}
+
+// NOTE: Helps with both queues, work in this one might wait on the other one
 void Win32CompleteAllWork(WorkQueue* queue) {
-    auto threadId = GetCurrentThreadId();
-    while (queue->pendingWorkCount != queue->completedWorkCount) {
-        Win32DoWorkerWork(queue, threadId);
-    }
-    queue->pendingWorkCount = 0;
-    queue->completedWorkCount = 0;
+    Win32HelpUntil(WorkQueueIsEmptyCondition, queue, 0.0);
+}
+
+MemoryArena* Win32GetScratchArena() {
+    panic(GlobalThreadIndex != WorkQueueForeignThread, "[Win32] Scratch arenas are owned only by main and worker threads");
+    return GlobalContext.scratchArenas[GlobalThreadIndex];
 }
 
 DWORD WINAPI Win32ThreadProc(void* param) {
@@ -1238,11 +1237,12 @@ DWORD WINAPI Win32ThreadProc(void* param) {
         _InterlockedExchange((long volatile*)&GlobalContext.state.supportsAsyncGPUTransfer, 0);
     }
 #endif
+    GlobalThreadIndex = threadInfo->index;
     while (true) {
-        auto didHighPriorityWork = Win32DoWorkerWork(highPriorityQueue, threadInfo->index);
+        auto didHighPriorityWork = WorkQueueDoWork(highPriorityQueue, threadInfo->index);
         if (!didHighPriorityWork) {
             //WaitForSingleObjectEx(highPriorityQueue->semaphore, 0, FALSE);
-            auto didLowPriorityWork = Win32DoWorkerWork(lowPriorityQueue, threadInfo->index);
+            auto didLowPriorityWork = WorkQueueDoWork(lowPriorityQueue, threadInfo->index);
             if (!didLowPriorityWork) {
                 WaitForSingleObjectEx(GlobalContext.workQueueSemaphore, INFINITE, FALSE);
             }
@@ -1287,17 +1287,49 @@ void Win32DeallocatePages(void* memory, uptr size) {
     assert(result);
 }
 
+uptr Win32GetPageSize() {
+    static uptr pageSize = 0;
+    if (!pageSize) {
+        SYSTEM_INFO info;
+        GetSystemInfo(&info);
+        pageSize = (uptr)info.dwPageSize;
+    }
+    return pageSize;
+}
+
+bool Win32CommitMemory(void* memory, uptr size) {
+    auto result = VirtualAlloc(memory, size, MEM_COMMIT, PAGE_READWRITE);
+    return result != nullptr;
+}
+
+// NOTE: Only pages which are entirely inside the range. Edge pages might be shared with a neighbour
+void Win32DecommitMemory(void* memory, uptr size) {
+    auto pageSize = Win32GetPageSize();
+    auto begin = AlignUp((uptr)memory, pageSize);
+    auto end = AlignDown((uptr)memory + size, pageSize);
+    if (end > begin) {
+        auto result = VirtualFree((void*)begin, end - begin, MEM_DECOMMIT);
+        assert(result);
+    }
+}
+
+// NOTE: Only reserves address space. Arena commits pages as it grows
 MemoryArena* Win32AllocateArena(uptr size) {
     uptr headerSize = sizeof(MemoryArena);
     void* mem = VirtualAlloc(0, size + headerSize,
-                             MEM_RESERVE | MEM_COMMIT,
-                             PAGE_READWRITE);
+                             MEM_RESERVE,
+                             PAGE_NOACCESS);
     assert(mem, "Allocation failed");
     assert((uptr)mem % 128 == 0, "Memory aligment violation");
+    auto committed = Win32CommitMemory(mem, headerSize);
+    assert(committed, "Commit failed");
     MemoryArena header = {};
     header.free = size;
     header.size = size;
     header.begin = (void*)((byte*)mem + headerSize);
+    header.retainSize = MemoryArenaDefaultRetainSize;
+    header.Commit = Win32CommitMemory;
+    header.Decommit = Win32DecommitMemory;
     memcpy(mem, &header, sizeof(MemoryArena));
     return (MemoryArena*)mem;
 }
@@ -1345,6 +1377,16 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
     auto lowQueue = &app->lowPriorityQueue;
     auto highQueue = &app->highPriorityQueue;
 
+    for (u32x i = 0; i < array_count(app->scratchArenas); i++) {
+        app->scratchArenas[i] = Win32AllocateArena(WorkScratchArenaSize);
+        app->scratchArenas[i]->isTemporary = true;
+    }
+
+    // NOTE: Workers get indices [0, NumOfWorkerThreads), main thread is the last one
+    InitWorkQueue(lowQueue, NumOfWorkerThreads + 1, Win32SignalWorkers, app->scratchArenas);
+    InitWorkQueue(highQueue, NumOfWorkerThreads + 1, Win32SignalWorkers, app->scratchArenas);
+    GlobalThreadIndex = NumOfWorkerThreads;
+
     Win32ThreadInfo threadInfo[NumOfWorkerThreads];
     auto semaphore = CreateSemaphoreEx(0, 0, array_count(threadInfo), nullptr, 0, SEMAPHORE_ALL_ACCESS);
 
@@ -1354,7 +1396,7 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
         auto info = threadInfo + i;
         DWORD threadId;
         auto threadHandle = CreateThread(0, 0, Win32ThreadProc, (void*)info, CREATE_SUSPENDED, &threadId);
-        info->index = GetThreadId(threadHandle);
+        info->index = i;
         info->lowPriorityQueue = lowQueue;
         info->highPriorityQueue = highQueue;
         info->glrc = app->workersGLRC[i];
@@ -1391,7 +1433,12 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
     app->state.functions.FreeArena = Win32FreeArena;
 
     app->state.functions.PushWork = Win32PushWork;
+    app->state.functions.PushWorkWithCounter = Win32PushWorkWithCounter;
+    app->state.functions.ReleaseWorkCounter = Win32ReleaseWorkCounter;
     app->state.functions.CompleteAllWork = Win32CompleteAllWork;
+    app->state.functions.HelpUntil = Win32HelpUntil;
+    app->state.functions.WaitForWorkCounter = Win32WaitForWorkCounter;
+    app->state.functions.GetScratchArena = Win32GetScratchArena;
     app->state.functions.SetSaveThreadWork = Win32SetSaveThreadWork;
 
     app->state.functions.GetTimeStamp = GetTimeStamp;
@@ -1438,6 +1485,7 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
     {
         app->state.tickCount++;
         auto tickStartTime = GetTimeStamp();
+        app->state.frameHelpDeadline = tickStartTime + SECONDS_PER_TICK * FRAME_HELP_BUDGET;
 
         WindowPollEvents(app);
 
@@ -1510,6 +1558,7 @@ int WINAPI WinMain(HINSTANCE instance, HINSTANCE prevInstance, LPSTR cmdLine, in
 }
 
 #include "Win32CodeLoader.cpp"
+#include "WorkQueue.cpp"
 
 // Functions used by imgui
 
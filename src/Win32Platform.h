@@ -1,5 +1,6 @@
 #pragma once
 #include "Platform.h"
+#include "WorkQueue.h"
 #include <windows.h>
 
 #include "Win32CodeLoader.h"
@@ -11,8 +12,13 @@ constexpr u32 OPENGL_MAJOR_VERSION = 4;
 constexpr u32 OPENGL_MINOR_VERSION = 5;
 
 constexpr f64 SECONDS_PER_TICK = 1.0 / 60.0;
+// NOTE: Part of the tick the game may spend helping workers at the end of the update.
+// The rest is left for rendering and swap
+constexpr f64 FRAME_HELP_BUDGET = 0.5;
 
 const u32 NumOfWorkerThreads = 4;
+// NOTE: Main thread has its own deque too
+static_assert(NumOfWorkerThreads + 1 <= MaxWorkQueueThreads);
 
 //#define OPENGL_WORKER_CONTEXTS
 
@@ -66,21 +72,6 @@ extern "C"
     typedef int (APIENTRY wglGetSwapIntervalEXTFn)(void);
 }
 
-struct WorkQueueEntry {
-    void* data0;
-    void* data1;
-    void* data2;
-    WorkFn* function;
-};
-
-struct WorkQueue {
-    u32 volatile pendingWorkCount;
-    u32 volatile completedWorkCount;
-    u32 volatile begin;
-    u32 volatile end;
-    WorkQueueEntry queue[128];
-};
-
 struct Win32ThreadInfo {
     u32 index;
     WorkQueue* lowPriorityQueue;
@@ -103,6 +94,7 @@ struct Win32Context
     LibraryData gameLib;
     WorkQueue lowPriorityQueue;
     WorkQueue highPriorityQueue;
+    MemoryArena* scratchArenas[NumOfWorkerThreads + 1];
     HGLRC workersGLRC[NumOfWorkerThreads];
     HANDLE workQueueSemaphore;
     HANDLE saveThreadMutex;
@@ -0,0 +1,325 @@
+#include "WorkQueue.h"
+
+#if defined(COMPILER_MSVC)
+inline i64 WorkQueueCompareExchange(i64 volatile* dest, i64 comp, i64 newValue) {
+    return _InterlockedCompareExchange64((__int64 volatile*)dest, (__int64)newValue, (__int64)comp);
+}
+
+inline u32 WorkQueueIncrement(u32 volatile* dest) {
+    return (u32)_InterlockedIncrement((long volatile*)dest);
+}
+
+inline u32 WorkQueueDecrement(u32 volatile* dest) {
+    return (u32)_InterlockedDecrement((long volatile*)dest);
+}
+
+inline void WorkQueuePause() {
+    _mm_pause();
+}
+#else
+inline i64 WorkQueueCompareExchange(i64 volatile* dest, i64 comp, i64 newValue) {
+    return __sync_val_compare_and_swap(dest, comp, newValue);
+}
+
+inline u32 WorkQueueIncrement(u32 volatile* dest) {
+    return __sync_add_and_fetch(dest, 1);
+}
+
+inline u32 WorkQueueDecrement(u32 volatile* dest) {
+    return __sync_sub_and_fetch(dest, 1);
+}
+
+inline void WorkQueuePause() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#endif
+}
+#endif
+
+WorkDequeBuffer* AllocateWorkDequeBuffer(i64 capacity) {
+    assert(IsPowerOfTwo((u32)capacity));
+    auto size = sizeof(WorkDequeBuffer) + sizeof(WorkQueueEntry) * (capacity - 1);
+    auto buffer = (WorkDequeBuffer*)malloc(size);
+    panic(buffer, "[Work queue] Failed to allocate deque buffer");
+    buffer->capacity = capacity;
+    buffer->prev = nullptr;
+    return buffer;
+}
+
+void InitWorkQueue(WorkQueue* queue, u32 threadCount, WorkQueueSignalFn* signal, MemoryArena** scratchArenas) {
+    panic(threadCount <= MaxWorkQueueThreads, "[Work queue] Too many threads");
+    queue->Signal = signal;
+    queue->scratchArenas = scratchArenas;
+    queue->pendingWorkCount = 0;
+    queue->completedWorkCount = 0;
+    queue->threadCount = threadCount;
+    for (u32 i = 0; i < threadCount; i++) {
+        auto deque = queue->deques + i;
+        deque->top = 0;
+        deque->bottom = 0;
+        deque->buffer = AllocateWorkDequeBuffer(WorkDequeInitialCapacity);
+    }
+    auto injection = &queue->injection;
+    injection->enqueuePos = 0;
+    injection->dequeuePos = 0;
+    for (i64 i = 0; i < WorkInjectionQueueCapacity; i++) {
+        injection->cells[i].sequence = i;
+    }
+}
+
+WorkDequeBuffer* GrowWorkDeque(WorkDeque* deque, WorkDequeBuffer* buffer, i64 bottom, i64 top) {
+    auto newBuffer = AllocateWorkDequeBuffer(buffer->capacity * 2);
+    for (i64 i = top; i < bottom; i++) {
+        newBuffer->entries[i & (newBuffer->capacity - 1)] = buffer->entries[i & (buffer->capacity - 1)];
+    }
+    newBuffer->prev = buffer;
+    CompilerBarrier();
+    deque->buffer = newBuffer;
+    return newBuffer;
+}
+
+void WorkQueuePush(WorkQueue* queue, u32 threadIndex, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2) {
+    assert(threadIndex < queue->threadCount);
+    if (counter) {
+        WorkQueueIncrement(&counter->value);
+    }
+    auto deque = queue->deques + threadIndex;
+    auto bottom = deque->bottom;
+    auto top = deque->top;
+    auto buffer = deque->buffer;
+    if (bottom - top > buffer->capacity - 1) {
+        buffer = GrowWorkDeque(deque, buffer, bottom, top);
+    }
+    auto entry = buffer->entries + (bottom & (buffer->capacity - 1));
+    entry->function = fn;
+    entry->data0 = data0;
+    entry->data1 = data1;
+    entry->data2 = data2;
+    entry->counter = counter;
+    WorkQueueIncrement(&queue->pendingWorkCount);
+    // NOTE: Entry should be visible before the bottom is moved. Stores are not reordered on x86
+    CompilerBarrier();
+    deque->bottom = bottom + 1;
+    if (queue->Signal) {
+        queue->Signal();
+    }
+}
+
+bool WorkQueueInject(WorkQueue* queue, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2) {
+    static_assert(IsPowerOfTwo((u32)WorkInjectionQueueCapacity));
+    constexpr i64 mask = WorkInjectionQueueCapacity - 1;
+    bool result = false;
+    auto injection = &queue->injection;
+    WorkInjectionCell* cell = nullptr;
+    auto pos = injection->enqueuePos;
+    while (true) {
+        cell = injection->cells + (pos & mask);
+        auto sequence = cell->sequence;
+        CompilerBarrier();
+        auto diff = sequence - pos;
+        if (diff == 0) {
+            auto prevPos = WorkQueueCompareExchange(&injection->enqueuePos, pos, pos + 1);
+            if (prevPos == pos) {
+                result = true;
+                break;
+            }
+            pos = prevPos;
+        } else if (diff < 0) {
+            // NOTE: Full
+            break;
+        } else {
+            pos = injection->enqueuePos;
+        }
+    }
+    if (result) {
+        if (counter) {
+            WorkQueueIncrement(&counter->value);
+        }
+        auto entry = &cell->entry;
+        entry->function = fn;
+        entry->data0 = data0;
+        entry->data1 = data1;
+        entry->data2 = data2;
+        entry->counter = counter;
+        WorkQueueIncrement(&queue->pendingWorkCount);
+        CompilerBarrier();
+        cell->sequence = pos + 1;
+        if (queue->Signal) {
+            queue->Signal();
+        }
+    }
+    return result;
+}
+
+bool WorkInjectionQueuePop(WorkInjectionQueue* injection, WorkQueueEntry* result) {
+    constexpr i64 mask = WorkInjectionQueueCapacity - 1;
+    bool popped = false;
+    WorkInjectionCell* cell = nullptr;
+    auto pos = injection->dequeuePos;
+    while (true) {
+        cell = injection->cells + (pos & mask);
+        auto sequence = cell->sequence;
+        CompilerBarrier();
+        auto diff = sequence - (pos + 1);
+        if (diff == 0) {
+            auto prevPos = WorkQueueCompareExchange(&injection->dequeuePos, pos, pos + 1);
+            if (prevPos == pos) {
+                popped = true;
+                break;
+            }
+            pos = prevPos;
+        } else if (diff < 0) {
+            // NOTE: Empty
+            break;
+        } else {
+            pos = injection->dequeuePos;
+        }
+    }
+    if (popped) {
+        *result = cell->entry;
+        CompilerBarrier();
+        cell->sequence = pos + mask + 1;
+    }
+    return popped;
+}
+
+void WorkCounterRelease(WorkCounter* counter, u32 threadIndex) {
+    // NOTE: Copying the successor first. Counter might be reused by its owner as soon as it reaches zero
+    auto successor = *counter;
+    CompilerBarrier();
+    auto value = WorkQueueDecrement(&counter->value);
+    assert(value != U32::Max);
+    if (value == 0 && successor.successor) {
+        if (threadIndex == WorkQueueForeignThread) {
+            // NOTE: Successor can't be dropped, so waiting for the room in the injection queue
+            while (!WorkQueueInject(successor.successorQueue, nullptr, successor.successor, successor.successorData0, successor.successorData1, successor.successorData2)) {}
+        } else {
+            WorkQueuePush(successor.successorQueue, threadIndex, nullptr, successor.successor, successor.successorData0, successor.successorData1, successor.successorData2);
+        }
+    }
+}
+
+bool WorkDequePop(WorkDeque* deque, WorkQueueEntry* result) {
+    bool popped = false;
+    auto bottom = deque->bottom - 1;
+    auto buffer = deque->buffer;
+    deque->bottom = bottom;
+    // NOTE: Store to bottom must not be reordered with the load of top
+    FullFence();
+    auto top = deque->top;
+    if (top <= bottom) {
+        *result = buffer->entries[bottom & (buffer->capacity - 1)];
+        popped = true;
+        if (top == bottom) {
+            // NOTE: Last entry. Racing with thieves for it
+            if (WorkQueueCompareExchange(&deque->top, top, top + 1) != top) {
+                popped = false;
+            }
+            deque->bottom = bottom + 1;
+        }
+    } else {
+        deque->bottom = bottom + 1;
+    }
+    return popped;
+}
+
+bool WorkDequeSteal(WorkDeque* deque, WorkQueueEntry* result) {
+    bool stolen = false;
+    auto top = deque->top;
+    FullFence();
+    auto bottom = deque->bottom;
+    if (top < bottom) {
+        auto buffer = deque->buffer;
+        CompilerBarrier();
+        *result = buffer->entries[top & (buffer->capacity - 1)];
+        if (WorkQueueCompareExchange(&deque->top, top, top + 1) == top) {
+            stolen = true;
+        }
+    }
+    return stolen;
+}
+
+bool WorkQueueDoWork(WorkQueue* queue, u32 threadIndex) {
+    assert(threadIndex < queue->threadCount);
+    WorkQueueEntry entry;
+    bool found = WorkDequePop(queue->deques + threadIndex, &entry);
+    if (!found) {
+        found = WorkInjectionQueuePop(&queue->injection, &entry);
+    }
+    if (!found) {
+        for (u32 i = 1; i < queue->threadCount; i++) {
+            auto victim = (threadIndex + i) % queue->threadCount;
+            if (WorkDequeSteal(queue->deques + victim, &entry)) {
+                found = true;
+                break;
+            }
+        }
+    }
+    if (found) {
+        if (entry.function) {
+            // NOTE: Work might run nested (i.e. main thread helps while it uses its scratch),
+            // so the arena is rewound to where it was instead of being cleared
+            auto scratch = queue->scratchArenas[threadIndex];
+            auto scratchMemory = BeginTemporaryMemory(scratch);
+            entry.function(entry.data0, entry.data1, entry.data2, threadIndex, scratch);
+            EndTemporaryMemory(&scratchMemory);
+        }
+        if (entry.counter) {
+            WorkCounterRelease(entry.counter, threadIndex);
+        }
+        WorkQueueIncrement(&queue->completedWorkCount);
+    }
+    return found;
+}
+
+bool WorkQueueIsEmpty(WorkQueue* queue) {
+    return queue->pendingWorkCount == queue->completedWorkCount;
+}
+
+b32 WorkQueueIsEmptyCondition(void* queue) {
+    return WorkQueueIsEmpty((WorkQueue*)queue);
+}
+
+b32 WorkCounterIsZeroCondition(void* counter) {
+    return ((WorkCounter*)counter)->value == 0;
+}
+
+// NOTE: Work can't be interrupted, so helping before a deadline stops when the next piece
+// of work likely won't fit. Estimate follows the longest recent work and decays slowly
+static thread_local f64 WorkQueueHelpWorkTimeEstimate = 0.0;
+
+bool WorkQueuesHelpUntil(WorkQueue** queues, u32 queueCount, u32 threadIndex, HelpConditionFn* condition, void* data, f64 deadline) {
+    bool result = false;
+    while (true) {
+        if (condition && condition(data)) {
+            result = true;
+            break;
+        }
+        // NOTE: GetTimeStamp is provided by the platform layer which includes this file
+        f64 workBeginTime = deadline != 0.0 ? GetTimeStamp() : 0.0;
+        if (deadline != 0.0 && (workBeginTime + WorkQueueHelpWorkTimeEstimate) >= deadline) {
+            // NOTE: Decaying here too, so one long piece of work doesn't stop helping for good
+            WorkQueueHelpWorkTimeEstimate *= 0.9;
+            break;
+        }
+        bool didWork = false;
+        for (u32 i = 0; i < queueCount; i++) {
+            if (WorkQueueDoWork(queues[i], threadIndex)) {
+                didWork = true;
+                break;
+            }
+        }
+        if (didWork && deadline != 0.0) {
+            auto workTime = GetTimeStamp() - workBeginTime;
+            WorkQueueHelpWorkTimeEstimate = Max(workTime, WorkQueueHelpWorkTimeEstimate * 0.9);
+        }
+        if (!didWork) {
+            if (!condition) {
+                break;
+            }
+            // NOTE: Remaining work is being done by other threads
+            WorkQueuePause();
+        }
+    }
+    return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+#include "Platform.h"
+#include "Memory.h"
+
+// NOTE: Shared by platform layers. Each priority level is a WorkQueue which owns one
+// Chase-Lev deque per thread. A thread pushes to and pops from the bottom of its own deque,
+// idle threads steal from the top of others. Deques grow, so pushing work never fails.
+// Threads which don't own a deque (i.e. save thread) push to a shared bounded MPMC queue,
+// which is drained by the pool threads too. It is the only push that can fail.
+// [https://www.dre.vanderbilt.edu/~schmidt/PDF/work-stealing-dequeue.pdf]
+// [https://fzn.fr/readings/ppopp13.pdf]
+
+constexpr u32 MaxWorkQueueThreads = 16;
+// NOTE: Thread index of threads which don't own a deque
+constexpr u32 WorkQueueForeignThread = 0xffffffff;
+constexpr i64 WorkInjectionQueueCapacity = 4096;
+constexpr i64 WorkDequeInitialCapacity = 256;
+// NOTE: Per-thread arena for work temporaries. Should fit a few mesh blocks at least
+constexpr uptr WorkScratchArenaSize = 32 * 1024 * 1024;
+
+struct WorkQueueEntry {
+    void* data0;
+    void* data1;
+    void* data2;
+    WorkFn* function;
+    WorkCounter* counter;
+};
+
+// NOTE: Called after work was pushed to wake up sleeping workers
+typedef void(WorkQueueSignalFn)();
+
+struct WorkDequeBuffer {
+    i64 capacity;
+    // NOTE: Retired buffers are kept alive because thieves might still read from them
+    WorkDequeBuffer* prev;
+    WorkQueueEntry entries[1];
+};
+
+struct alignas(64) WorkDeque {
+    i64 volatile top;
+    byte _pad0[64 - sizeof(i64)];
+    i64 volatile bottom;
+    WorkDequeBuffer* volatile buffer;
+};
+
+// NOTE: Bounded MPMC queue. Every cell has a sequence number which tells producers and
+// consumers whether the cell is ready for them at the current position.
+// [https://www.1024cores.net/home/lock-free-algorithms/queues/bounded-mpmc-queue]
+struct WorkInjectionCell {
+    i64 volatile sequence;
+    WorkQueueEntry entry;
+};
+
+struct alignas(64) WorkInjectionQueue {
+    i64 volatile enqueuePos;
+    byte _pad0[64 - sizeof(i64)];
+    i64 volatile dequeuePos;
+    byte _pad1[64 - sizeof(i64)];
+    WorkInjectionCell cells[WorkInjectionQueueCapacity];
+};
+
+struct WorkQueue {
+    u32 volatile pendingWorkCount;
+    u32 volatile completedWorkCount;
+    u32 threadCount;
+    WorkQueueSignalFn* Signal;
+    // NOTE: Indexed by thread index. Shared by all queues, since a thread runs one work at a time
+    MemoryArena** scratchArenas;
+    WorkDeque deques[MaxWorkQueueThreads];
+    WorkInjectionQueue injection;
+};
+
+void InitWorkQueue(WorkQueue* queue, u32 threadCount, WorkQueueSignalFn* signal, MemoryArena** scratchArenas);
+// NOTE: Must be called only by the thread which owns deque with index threadIndex
+void WorkQueuePush(WorkQueue* queue, u32 threadIndex, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2);
+// NOTE: Safe to call from any thread. Returns false if the injection queue is full
+bool WorkQueueInject(WorkQueue* queue, WorkCounter* counter, WorkFn* fn, void* data0, void* data1, void* data2);
+// NOTE: Drops a reference. The last one pushes the successor to the calling thread's deque
+// (or injects it if the calling thread is WorkQueueForeignThread)
+void WorkCounterRelease(WorkCounter* counter, u32 threadIndex);
+// NOTE: Pops work from own deque or steals it from other threads. Returns false if there was no work
+bool WorkQueueDoWork(WorkQueue* queue, u32 threadIndex);
+bool WorkQueueIsEmpty(WorkQueue* queue);
+// NOTE: Runs work from the queues (in order of priority) on the calling thread. See HelpUntilFn
+bool WorkQueuesHelpUntil(WorkQueue** queues, u32 queueCount, u32 threadIndex, HelpConditionFn* condition, void* data, f64 deadline);
+b32 WorkQueueIsEmptyCondition(void* queue);
+b32 WorkCounterIsZeroCondition(void* counter);
@@ -9,8 +9,10 @@ Chunk* AllocateWorldChunk(WorldMemory* memory) {
     if (memory->chunkMemoryFreeList) {
         result = memory->chunkMemoryFreeList;
         memory->chunkMemoryFreeList = memory->chunkMemoryFreeList->nextInFreeList;
-        // TODO: Maybe clearing the whole chunk is too slow
-        ClearMemory(result);
+        // NOTE: Only the header. Payload is written by workers when the chunk is filled
+        assert(!result->blocks.indices);
+        assert(!result->blocks.retired);
+        memset(result, 0, offsetof(Chunk, blocks));
         memory->chunksUsed++;
         assert(memory->chunksFree);
         memory->chunksFree--;
@@ -33,6 +35,9 @@ void FreeWorldChunk(WorldMemory* memory, Chunk* chunk) {
     assert(!chunk->primaryMesh);
     assert(!chunk->secondaryMesh);
 
+    FreeChunkBlockStorage(chunk);
+    FreeChunkBlockEntityIndex(chunk);
+
     chunk->nextInFreeList = memory->chunkMemoryFreeList;
     memory->chunkMemoryFreeList = chunk;
     assert(memory->chunksUsed);
@@ -79,10 +84,25 @@ Chunk* AddChunk(GameWorld* world, iv3 coord) {
     auto chunk = AllocateWorldChunk(&world->memory);
     assert(chunk);
     chunk->p = coord;
-    chunk->priority = ChunkPriority::Low;
     auto entry = Add(&world->chunkHashMap, &chunk->p);
     assert(entry);
     *entry = chunk;
+    for (i32 z = -1; z <= 1; z++) {
+        for (i32 y = -1; y <= 1; y++) {
+            for (i32 x = -1; x <= 1; x++) {
+                auto index = ChunkNeighborIndex(x, y, z);
+                if (index == ChunkNeighborSelf) {
+                    chunk->neighbors[index] = chunk;
+                } else {
+                    auto neighbor = GetChunkInternal(world, coord.x + x, coord.y + y, coord.z + z);
+                    if (neighbor) {
+                        chunk->neighbors[index] = neighbor;
+                        neighbor->neighbors[ChunkNeighborCount - 1 - index] = chunk;
+                    }
+                }
+            }
+        }
+    }
     return chunk;
 }
 
@@ -90,6 +110,20 @@ void DeleteChunk(GameWorld* world, Chunk* chunk) {
     timed_scope();
     bool deleted = Delete(&world->chunkHashMap, &chunk->p);
     assert(deleted);
+    for (u32 i = 0; i < ChunkNeighborCount; i++) {
+        auto neighbor = chunk->neighbors[i];
+        if (neighbor && i != ChunkNeighborSelf) {
+            assert(neighbor->neighbors[ChunkNeighborCount - 1 - i] == chunk);
+            neighbor->neighbors[ChunkNeighborCount - 1 - i] = nullptr;
+        }
+    }
+    // NOTE: Entities of unloaded chunk are gone, returning their slots to the pools.
+    // Freeing a slot doesn't touch the entity memory, so walking the storage is fine.
+    // Ids stay taken since the entities might be on disk
+    ForEach(&chunk->entityStorage, [&](Entity* it) {
+        UnregisterEntity(world, it->id);
+        FreeEntity(world, it);
+    });
     FreeWorldChunk(&world->memory, chunk);
 }
 
@@ -113,10 +147,71 @@ Chunk* GetChunk(GameWorld* world, i32 x, i32 y, i32 z) {
     return result;
 }
 
+void SetBlockCursor(BlockCursor* cursor, iv3 p) {
+    auto chunkP = WorldPos::ToChunk(p);
+    if (chunkP.chunk != cursor->chunkP) {
+        auto d = chunkP.chunk - cursor->chunkP;
+        if (cursor->chunk && (u32)(d.x + 1) <= 2 && (u32)(d.y + 1) <= 2 && (u32)(d.z + 1) <= 2) {
+            cursor->chunk = cursor->chunk->neighbors[ChunkNeighborIndex(d.x, d.y, d.z)];
+        } else {
+            cursor->chunk = GetChunkInternal(cursor->world, chunkP.chunk.x, chunkP.chunk.y, chunkP.chunk.z);
+        }
+        cursor->chunkP = chunkP.chunk;
+    }
+    cursor->p = p;
+    cursor->block = chunkP.block;
+}
+
+BlockCursor MakeBlockCursor(GameWorld* world, Chunk* chunk, iv3 p) {
+    BlockCursor cursor = {};
+    cursor.world = world;
+    if (chunk) {
+        cursor.chunk = chunk;
+        cursor.chunkP = chunk->p;
+    } else {
+        auto chunkP = WorldPos::ToChunk(p).chunk;
+        cursor.chunk = GetChunkInternal(world, chunkP.x, chunkP.y, chunkP.z);
+        cursor.chunkP = chunkP;
+    }
+    SetBlockCursor(&cursor, p);
+    return cursor;
+}
+
+BlockCursor MakeBlockCursor(GameWorld* world, iv3 p) {
+    return MakeBlockCursor(world, nullptr, p);
+}
+
+BlockValue GetBlockValue(BlockCursor* cursor) {
+    BlockValue result = cursor->world->nullBlockValue;
+    auto chunk = cursor->chunk;
+    if (chunk && chunk->filled) {
+        result = GetBlockValue(chunk, cursor->block.x, cursor->block.y, cursor->block.z);
+    }
+    return result;
+}
+
+BlockEntity* GetBlockEntity(BlockCursor* cursor) {
+    BlockEntity* result = nullptr;
+    auto chunk = cursor->chunk;
+    if (chunk && chunk->filled) {
+        result = GetBlockEntity(chunk, cursor->block.x, cursor->block.y, cursor->block.z);
+    }
+    return result;
+}
+
+Block GetBlock(BlockCursor* cursor) {
+    Block result = { cursor->world->nullBlockValue, nullptr };
+    auto chunk = cursor->chunk;
+    if (chunk && chunk->filled) {
+        result = GetBlock(chunk, cursor->block.x, cursor->block.y, cursor->block.z);
+    }
+    return result;
+}
+
 void InitWorld(GameWorld* world, Context* context, ChunkMesher* mesher, u32 seed, const char* name) {
     timed_scope();
     world->chunkHashMap = HashMap<iv3, Chunk*, ChunkHashFunc, ChunkHashCompFunc>::Make();
-    world->entityHashMap = HashMap<EntityID, Entity*, EntityRegionHashFunc, EntityRegionHashCompFunc>::Make();
+    InitEntityTable(&world->entityTable, PlatformAllocateArena(sizeof(EntityTableSlot) * EntityTable::MaxSlotCount));
 
     world->memory.PageAlloc = PlatformAllocatePages;
     world->memory.PageDealloc = PlatformDeallocatePages;
@@ -138,8 +233,41 @@ void InitWorld(GameWorld* world, Context* context, ChunkMesher* mesher, u32 seed
     }
 }
 
+Entity* AllocateEntity(GameWorld* world, EntityType type) {
+    Entity* result = nullptr;
+    assert((u32)type < (u32)EntityType::_Count);
+    auto pool = world->entityPools + (u32)type;
+    if (!pool->stride) {
+        auto info = GetEntityInfo(type);
+        InitEntityPool(pool, PlatformAllocatePages, info->size, info->alignment);
+    }
+    EntityHandle handle;
+    result = EntityPoolAllocate(pool, &handle);
+    if (result) {
+        result->type = type;
+        result->poolHandle = handle;
+    }
+    return result;
+}
+
+void FreeEntity(GameWorld* world, Entity* entity) {
+    auto pool = world->entityPools + (u32)entity->type;
+    EntityPoolFree(pool, entity->poolHandle);
+}
+
+template <typename F>
+void ForEachActiveEntity(GameWorld* world, F func) {
+    for (u32 i = 0; i < array_count(world->entityPools); i++) {
+        ForEach(world->entityPools + i, [&](Entity* it) {
+            if (it->active) {
+                func(it);
+            }
+        });
+    }
+}
+
 template <typename T>
-T* AddSpatialEntity(GameWorld* world, WorldPos p) {
+T* AddSpatialEntity(GameWorld* world, EntityType type, WorldPos p) {
     timed_scope();
     // Trigger compiler error if T isn 't inherited from SpatialEntity
     static_cast<T*>(((SpatialEntity*)(0)));
@@ -148,10 +276,11 @@ T* AddSpatialEntity(GameWorld* world, WorldPos p) {
     auto chunkP = WorldPos::ToChunk(worldPos).chunk;
     auto chunk = GetChunk(world, chunkP.x, chunkP.y, chunkP.z);
     if (chunk) {
-        entity = (T*)PlatformAlloc(sizeof(T), alignof(T), nullptr);
+        assert(GetEntityInfo(type)->size == sizeof(T));
+        entity = (T*)AllocateEntity(world, type);
         if (entity) {
-            ClearMemory(entity);
             EntityStorageInsert(&chunk->entityStorage, entity);
+            entity->chunk = chunk;
             entity->id = GenEntityID(world, EntityKind::Spatial);
             entity->kind = EntityKind::Spatial;
             // NOTE: All spatial entitites propagates sim for now
@@ -160,7 +289,9 @@ T* AddSpatialEntity(GameWorld* world, WorldPos p) {
             entity->world = world;
             entity->friction = 10.0f;
             entity->currentChunk = chunk->p;
+            entity->active = chunk->active;
             chunk->simPropagationCount++;
+            WakeChunk(chunk);
             if (chunk->active) {
                 RegisterEntity(world, entity);
             }
@@ -179,14 +310,18 @@ SpatialEntity* RestoreSpatialEntity(GameWorld* world, EntityID id, u32 type, u32
         auto chunk = GetChunk(world, chunkP.x, chunkP.y, chunkP.z);
 
         if (chunk) {
-            entity = (SpatialEntity*)PlatformAlloc(info->size, info->alignment, nullptr);
+            entity = (SpatialEntity*)AllocateEntity(world, (EntityType)type);
             if (entity) {
-                memset(entity, 0, info->size);
                 EntityStorageInsert(&chunk->entityStorage, entity);
-                // TODO: Validate id;
+                entity->chunk = chunk;
+                // NOTE: Id is taken by another entity only if the world file is older than the chunk files
+                if (!EntityTableAcquire(&world->entityTable, id)) {
+                    auto newID = GenEntityID(world, EntityKind::Spatial);
+                    log_print("[World] Entity id %llu is taken, restoring the entity with id %llu\n", id, newID);
+                    id = newID;
+                }
                 entity->id = id;
                 entity->kind = EntityKind::Spatial;
-                entity->type = (EntityType)type;
                 // NOTE: All spatial entitites propagates sim for now
                 entity->flags = flags;
                 // TODO: Entity default params
@@ -197,7 +332,9 @@ SpatialEntity* RestoreSpatialEntity(GameWorld* world, EntityID id, u32 type, u32
                 entity->scale = scale;
                 entity->acceleration = acceleration;
                 entity->currentChunk = chunk->p;
+                entity->active = chunk->active;
                 chunk->simPropagationCount++;
+                WakeChunk(chunk);
                 if (chunk->active) {
                     RegisterEntity(world, entity);
                 }
@@ -211,11 +348,7 @@ SpatialEntity* RestoreSpatialEntity(GameWorld* world, EntityID id, u32 type, u32
 
 Entity* GetEntity(GameWorld* world, EntityID id) {
     timed_scope();
-    Entity* result = nullptr;
-    auto ptr = Get(&world->entityHashMap, &id);
-    if (ptr) {
-        result = *ptr;
-    }
+    Entity* result = EntityTableGet(&world->entityTable, id);
     return result;
 }
 
@@ -227,11 +360,13 @@ void PostEntityNeighborhoodUpdate(GameWorld* world, BlockEntity* entity) {
     timed_scope();
     iv3 min = entity->p - IV3(1);
     iv3 max = entity->p + IV3(1);
+    auto cursor = MakeBlockCursor(entity);
 
     for (i32 z = min.z; z <= max.z; z++) {
         for (i32 y = min.y; y <= max.y; y++) {
             for (i32 x = min.x; x <= max.x; x++) {
-                BlockEntity* neighbor = GetBlockEntity(world, IV3(x, y, z));
+                SetBlockCursor(&cursor, IV3(x, y, z));
+                BlockEntity* neighbor = GetBlockEntity(&cursor);
                 if (neighbor && (neighbor != entity)) {
                     entity->dirtyNeighborhood = true;
                 }
@@ -241,7 +376,7 @@ void PostEntityNeighborhoodUpdate(GameWorld* world, BlockEntity* entity) {
 }
 
 template <typename T>
-T* AddBlockEntity(GameWorld* world, iv3 p) {
+T* AddBlockEntity(GameWorld* world, EntityType type, iv3 p) {
     timed_scope();
     // TODO: Validate position
     T* entity = nullptr;
@@ -250,15 +385,17 @@ T* AddBlockEntity(GameWorld* world, iv3 p) {
     if (chunk) {
         auto block = GetBlock(chunk, chunkP.block);
         if (!IsBlockCollider(&block) && (block.entity == nullptr)) {
-            entity = (T*)PlatformAlloc(sizeof(T), alignof(T), nullptr);
+            assert(GetEntityInfo(type)->size == sizeof(T));
+            entity = (T*)AllocateEntity(world, type);
             if (entity) {
-                ClearMemory(entity);
                 EntityStorageInsert(&chunk->entityStorage, entity);
+                entity->chunk = chunk;
                 entity->id = GenEntityID(world, EntityKind::Block);
                 entity->kind = EntityKind::Block;
                 entity->p = p;
                 entity->flags |= EntityFlag_PropagatesSim;
                 entity->world = world;
+                entity->active = chunk->active;
                 auto occupied = OccupyBlock(chunk, entity, chunkP.block);
                 assert(occupied);
                 if (chunk->active) {
@@ -284,17 +421,22 @@ BlockEntity* RestoreBlockEntity(GameWorld* world, EntityID id, u32 type, u32 fla
         if (chunk) {
             auto block = GetBlock(chunk, chunkP.block);
             if (!IsBlockCollider(&block) && (block.entity == nullptr)) {
-                entity = (BlockEntity*)PlatformAlloc(info->size, info->alignment, nullptr);
+                entity = (BlockEntity*)AllocateEntity(world, (EntityType)type);
                 if (entity) {
-                    memset(entity, 0, info->size);
                     EntityStorageInsert(&chunk->entityStorage, entity);
-                    // TODO: Validate id
+                    entity->chunk = chunk;
+                    // NOTE: Id is taken by another entity only if the world file is older than the chunk files
+                    if (!EntityTableAcquire(&world->entityTable, id)) {
+                        auto newID = GenEntityID(world, EntityKind::Block);
+                        log_print("[World] Entity id %llu is taken, restoring the entity with id %llu\n", id, newID);
+                        id = newID;
+                    }
                     entity->id = id;
                     entity->kind = EntityKind::Block;
-                    entity->type = (EntityType)type;
                     entity->p = p;
                     entity->flags = flags;
                     entity->world = world;
+                    entity->active = chunk->active;
                     auto occupied = OccupyBlock(chunk, entity, chunkP.block);
                     assert(occupied);
                     if (chunk->active) {
@@ -340,6 +482,7 @@ void DeleteEntity(GameWorld* world, Entity* entity) {
         if (spatialEntity->flags & EntityFlag_PropagatesSim) {
             assert(chunk->simPropagationCount > 0);
             chunk->simPropagationCount--;
+            WakeChunk(chunk);
         }
         assert(chunk);
     } break;
@@ -347,8 +490,9 @@ void DeleteEntity(GameWorld* world, Entity* entity) {
     }
 
     UnregisterEntity(world, entity->id);
+    EntityTableFree(&world->entityTable, entity->id);
     EntityStorageUnlink(&chunk->entityStorage, entity);
-    PlatformFree(entity, nullptr);
+    FreeEntity(world, entity);
 }
 
 void ScheduleEntityForDelete(GameWorld* world, Entity* entity) {
@@ -422,10 +566,14 @@ bool UpdateEntityResidence(GameWorld* world, SpatialEntity* entity) {
                 assert(oldChunk->simPropagationCount > 0);
                 oldChunk->simPropagationCount--;
                 newChunk->simPropagationCount++;
+                WakeChunk(oldChunk);
+                WakeChunk(newChunk);
             }
 
             EntityStorageUnlink(&oldChunk->entityStorage, entity);
             EntityStorageInsert(&newChunk->entityStorage, entity);
+            entity->chunk = newChunk;
+            entity->active = newChunk->active;
             changedResidence = true;
             entity->currentChunk = newChunk->p;
             log_print("[World] Entity %lu changed it's residence (%ld, %ld, %ld) -> (%ld, %ld, %ld)\n", entity->id, oldChunk->p.x, oldChunk->p.y, oldChunk->p.z, newChunk->p.x, newChunk->p.y, newChunk->p.z);
@@ -502,6 +650,7 @@ OverlapResolveResult TryResolveOverlaps(GameWorld* world, SpatialEntity* entity)
 
     iv3 bboxMin = WorldPos::Offset(origin, -colliderRadius).block - IV3(1);
     iv3 bboxMax = WorldPos::Offset(origin, colliderRadius).block + IV3(1);
+    auto cursor = MakeBlockCursor(world, entity->chunk, bboxMin);
 
     for (i32 z = bboxMin.z; z <= bboxMax.z; z++) {
         for (i32 y = bboxMin.y; y <= bboxMax.y; y++) {
@@ -514,7 +663,8 @@ OverlapResolveResult TryResolveOverlaps(GameWorld* world, SpatialEntity* entity)
 
                 // TODO: Handle case when entity is outside of world bounds
                 if (y >= GameWorld::MinHeight && y <= GameWorld::MaxHeight) {
-                    auto testBlock = GetBlock(world, x, y, z);
+                    SetBlockCursor(&cursor, IV3(x, y, z));
+                    auto testBlock = GetBlock(&cursor);
                     bool collides = IsBlockCollider(&testBlock);
                     if (collides) {
                         v3 relOrigin = WorldPos::Relative(WorldPos::Make(IV3(x, y, z)), origin);
@@ -539,7 +689,10 @@ OverlapResolveResult TryResolveOverlaps(GameWorld* world, SpatialEntity* entity)
                             for (i32 pz = penetratedBlock.z - 1; pz <= penetratedBlock.z + 1; pz++) {
                                 for (i32 py = penetratedBlock.y - 1; py <= penetratedBlock.y + 1; py++) {
                                     for (i32 px = penetratedBlock.x - 1; px <= penetratedBlock.x + 1; px++) {
-                                        auto neighborBlock = GetBlock(world, px, py, pz);
+                                        // NOTE: Separate cursor, the outer one keeps walking the box
+                                        auto neighborCursor = cursor;
+                                        SetBlockCursor(&neighborCursor, IV3(px, py, pz));
+                                        auto neighborBlock = GetBlock(&neighborCursor);
                                         if (!IsBlockCollider(&neighborBlock)) {
                                             hasFreeNeighbor = true;
                                             v3 neighborRelOrigin = WorldPos::Relative(WorldPos::Make(IV3(x, y, z)), WorldPos::Make(IV3(px, py, pz)));
@@ -622,12 +775,13 @@ void MoveSpatialEntity(GameWorld* world, SpatialEntity* entity, v3 delta, Camera
             //max -= V3(Globals::BlockHalfDim);
             DrawAlignedBoxOutline(renderGroup, min, max, V3(0.0f, 0.0f, 1.0f), 2.0f);
 #endif
+            auto cursor = MakeBlockCursor(world, entity->chunk, minB);
             for (i32 z = minB.z; z <= maxB.z; z++) {
                 for (i32 y = minB.y; y <= maxB.y; y++) {
                     for (i32 x = minB.x; x <= maxB.x; x++) {
                         if (y >= GameWorld::MinHeight && y <= GameWorld::MaxHeight) {
-                            // TODO: Cache chunk pointer
-                            auto testBlock = GetBlock(world, x, y, z);
+                            SetBlockCursor(&cursor, IV3(x, y, z));
+                            auto testBlock = GetBlock(&cursor);
                             bool collides = IsBlockCollider(&testBlock);
                             if (collides) {
                                 v3 relOrigin = WorldPos::Relative(WorldPos::Make(IV3(x, y, z)), origin);
@@ -694,8 +848,7 @@ void ConvertBlockToPickup(GameWorld* world, iv3 voxelP) {
         if (blockInfo->DropPickup) {
             blockInfo->DropPickup(&block, world, WorldPos::Make(voxelP));
         }
-        auto blockToModify = GetBlockForModification(chunk, chunkPos.block.x, chunkPos.block.y, chunkPos.block.z);
-        *blockToModify = BlockValue::Empty;
+        ModifyBlock(chunk, chunkPos.block.x, chunkPos.block.y, chunkPos.block.z, BlockValue::Empty);
     }
 
     if (block.entity) {
@@ -735,6 +888,8 @@ bool SetBlockEntityPos(GameWorld* world, BlockEntity* entity, iv3 newP) {
                 assert(released);
                 EntityStorageUnlink(&oldChunk->entityStorage, entity);
                 EntityStorageInsert(&newChunk->entityStorage, entity);
+                entity->chunk = newChunk;
+                entity->active = newChunk->active;
                 log_print("[World] Block entity %lu changed it's residence (%ld, %ld, %ld) -> (%ld, %ld, %ld)\n", entity->id, oldChunk->p.x, oldChunk->p.y, oldChunk->p.z, newChunk->p.x, newChunk->p.y, newChunk->p.z);
                 entity->p = newP;
                 moved = true;
@@ -754,9 +909,8 @@ bool BuildBlock(Context* context, GameWorld* world, iv3 p, Item item) {
         auto chunkPos = WorldPos::ToChunk(p);
         auto chunk = GetChunk(world, chunkPos.chunk.x, chunkPos.chunk.y, chunkPos.chunk.z);
         if (chunk) {
-            auto block = GetBlockForModification(chunk, chunkPos.block.x, chunkPos.block.y, chunkPos.block.z);
-            assert(block);
-            *block = blockValue;
+            auto modified = ModifyBlock(chunk, chunkPos.block.x, chunkPos.block.y, chunkPos.block.z, blockValue);
+            assert(modified);
             result = true;
         }
     } else {
@@ -773,13 +927,12 @@ bool BuildBlock(Context* context, GameWorld* world, iv3 p, Item item) {
 
 void RegisterEntity(GameWorld* world, Entity* entity) {
     timed_scope();
-    auto entry = Add(&world->entityHashMap, &entity->id);
-    assert(entry);
-    *entry = entity;
+    auto registered = EntityTableSet(&world->entityTable, entity->id, entity);
+    assert(registered);
 }
 
 bool UnregisterEntity(GameWorld* world, EntityID id) {
     timed_scope();
-    bool result = Delete(&world->entityHashMap, &id);
+    bool result = EntityTableSet(&world->entityTable, id, nullptr);
     return result;
 }
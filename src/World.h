@@ -8,6 +8,7 @@
 #include "Memory.h"
 #include "Position.h"
 #include "Entity.h"
+#include "EntityTable.h"
 #include "ChunkPool.h"
 
 struct ChunkMesh;
@@ -23,8 +24,8 @@ struct Context;
 
 u32 ChunkHashFunc(void* value) {
     iv3* p = (iv3*)value;
-    // TODO: Reasonable hashing
-    u32 hash = p->x * 12342 + p->y * 23423 + p->z * 13;
+    u64 xz = ((u64)(u32)p->x << 32) | (u64)(u32)p->z;
+    u32 hash = (u32)HashMix64(xz ^ ((u64)(u32)p->y * 0x9e3779b97f4a7c15ull));
     return hash;
 }
 
@@ -35,20 +36,6 @@ bool ChunkHashCompFunc(void* a, void* b) {
     return result;
 }
 
-u32 EntityRegionHashFunc(void* value) {
-    EntityID* p = (EntityID*)value;
-    // TODO: Reasonable hashing
-    u32 hash = (u32)(*p);
-    return hash;
-}
-
-bool EntityRegionHashCompFunc(void* a, void* b) {
-    EntityID* p1 = (EntityID*)a;
-    EntityID* p2 = (EntityID*)b;
-    bool result = (*p1 == *p2);
-    return result;
-}
-
 struct WorldMemory {
     AllocatePagesFn* PageAlloc;
     DeallocatePagesFn* PageDealloc;
@@ -72,7 +59,7 @@ struct GameWorld {
     WorldMemory memory;
     EntityID playerID;
     HashMap<iv3, Chunk*, ChunkHashFunc, ChunkHashCompFunc> chunkHashMap;
-    HashMap<EntityID, Entity*, EntityRegionHashFunc, EntityRegionHashCompFunc> entityHashMap;
+    EntityTable entityTable;
     // TODO: Dynamic view distance
     static const u32 ViewDistance = 4;
     Camera* camera;
@@ -85,6 +72,7 @@ struct GameWorld {
     BucketArray<Entity*, 16> entitiesToDelete;
     // TODO: Decide which type of storage use for these
     FlatArray<SpatialEntity*> entitiesToMove;
+    EntityPool entityPools[(u32)EntityType::_Count];
     // TODO: Is nullBlock actually good idea?
     BlockValue nullBlockValue;
     ChunkPool chunkPool;
@@ -112,14 +100,56 @@ Chunk* GetChunkInternal(GameWorld* world, i32 x, i32 y, i32 z);
 Chunk* GetChunk(GameWorld* world, i32 x, i32 y, i32 z);
 inline Chunk* GetChunk(GameWorld* world, iv3 chunkP) { return GetChunk(world, chunkP.x, chunkP.y, chunkP.z); }
 
+// NOTE: Walks blocks across chunk borders following chunk neighbor links, so moving to a nearby block
+// doesn't go to the hash map. Only jumps further than adjacent chunk or moves from a place where
+// there is no chunk do the lookup. Cursor must not be kept across adding or deleting chunks
+struct BlockCursor {
+    GameWorld* world;
+    iv3 p;
+    iv3 chunkP;
+    uv3 block;
+    // NOTE: Chunk at chunkP if it exists. Might be not filled
+    Chunk* chunk;
+};
+
+// NOTE: Chunk is a hint, it should be the chunk where p is or near to it. Looks it up if it's null
+BlockCursor MakeBlockCursor(GameWorld* world, Chunk* chunk, iv3 p);
+BlockCursor MakeBlockCursor(GameWorld* world, iv3 p);
+inline BlockCursor MakeBlockCursor(BlockEntity* entity) { return MakeBlockCursor(entity->world, entity->chunk, entity->p); }
+void SetBlockCursor(BlockCursor* cursor, iv3 p);
+inline void MoveBlockCursor(BlockCursor* cursor, iv3 offset) { SetBlockCursor(cursor, cursor->p + offset); }
+
+// NOTE: Same results as lookups by world position. Null values if chunk doesn't exist or isn't filled
+BlockValue GetBlockValue(BlockCursor* cursor);
+BlockEntity* GetBlockEntity(BlockCursor* cursor);
+Block GetBlock(BlockCursor* cursor);
+inline Chunk* GetChunk(BlockCursor* cursor) { return (cursor->chunk && cursor->chunk->filled) ? cursor->chunk : nullptr; }
+
+// NOTE: Lookups next to a block entity start from the entity's chunk, so they don't go to the hash map
+inline BlockEntity* GetNeighborBlockEntity(BlockEntity* entity, iv3 offset) {
+    auto cursor = MakeBlockCursor(entity);
+    MoveBlockCursor(&cursor, offset);
+    return GetBlockEntity(&cursor);
+}
+
+inline Block GetNeighborBlock(BlockEntity* entity, iv3 offset) {
+    auto cursor = MakeBlockCursor(entity);
+    MoveBlockCursor(&cursor, offset);
+    return GetBlock(&cursor);
+}
+
 bool CheckWorldBounds(WorldPos p);
 bool CheckWorldBounds(ChunkPos p);
 
+// NOTE: Returns zeroed entity of the type from the type's pool
+Entity* AllocateEntity(GameWorld* world, EntityType type);
+void FreeEntity(GameWorld* world, Entity* entity);
+
 template <typename T>
-T* AddSpatialEntity(GameWorld* world, WorldPos p);
+T* AddSpatialEntity(GameWorld* world, EntityType type, WorldPos p);
 
 template <typename T>
-T* AddBlockEntity(GameWorld* world, iv3 p);
+T* AddBlockEntity(GameWorld* world, EntityType type, iv3 p);
 
 SpatialEntity* RestoreSpatialEntity(GameWorld* world, EntityID id, u32 type, u32 flags, WorldPos p, v3 velocity, f32 scale, f32 acceleration, f32 friction);
 BlockEntity* RestoreBlockEntity(GameWorld* world, EntityID id, u32 type, u32 flags, iv3 p);
@@ -143,5 +173,9 @@ bool BuildBlock(Context* context, GameWorld* world, iv3 p, Item item);
 
 Entity* GetEntity(GameWorld* world, EntityID id);
 
+// NOTE: Visits entities of sim chunks, pool by pool
+template <typename F>
+void ForEachActiveEntity(GameWorld* world, F func);
+
 void RegisterEntity(GameWorld* world, Entity* entity);
 bool UnregisterEntity(GameWorld* world, EntityID id);
@@ -66,29 +66,66 @@ u32 GetHeightFromNoise(Noise2D* noise, i32 x, i32 z, u32 maxHeight) {
     return blockHeight;
 }
 
-void ChunkFillWork(void* data0, void* data1, void* data2, u32 threadID) {
+void ChunkFillWork(void* data0, void* data1, void* data2, u32 threadID, MemoryArena* scratch) {
     auto worldGen = (WorldGen*)data0;
     auto chunk = (Chunk*)data1;
-    GenChunk(worldGen, chunk);
-    auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)ChunkState::Filled);
-    assert(prevState == (u32)ChunkState::Filling);
+    auto handle = data2;
+    if (IsChunkJobCancelled(chunk, handle)) {
+        // NOTE: Chained mesher work runs anyway and reports the cancellation,
+        // chunk must not be unlocked before that
+        if (!chunk->meshAfterFill) {
+            auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)ChunkState::Cancelled);
+            assert(prevState == (u32)ChunkState::Filling);
+        }
+    } else {
+        GenChunk(worldGen, chunk, scratch);
+        // NOTE: When meshing is chained after the fill the chunk goes straight into meshing state.
+        // Mesher work is pushed by the chunk's work counter right after this work is done
+        auto nextState = chunk->meshAfterFill ? ChunkState::Meshing : ChunkState::Filled;
+        auto prevState = AtomicExchange((volatile u32*)&chunk->state, (u32)nextState);
+        assert(prevState == (u32)ChunkState::Filling);
+    }
 }
 
 bool ScheduleChunkFill(WorldGen* gen, Chunk* chunk) {
     bool result = false;
     chunk->state = ChunkState::Filling;
+    chunk->meshAfterFill = chunk->visible;
+    auto handle = GetChunkJobHandle(chunk);
     WriteFence();
-    if (PlatformPushWork(GetPlatform()->lowPriorityQueue, ChunkFillWork, gen, chunk, nullptr)) {
-        result = true;
-    }
-    else {
-        chunk->state = ChunkState::Complete;
+    if (chunk->meshAfterFill) {
+        // NOTE: Visible chunk already owns a mesh and can't lose it while it is locked,
+        // so it can be meshed by workers right after the fill without waiting for the main thread
+        assert(chunk->locked);
+        assert(chunk->primaryMesh);
+        SnapshotChunkMeshBorders(chunk);
+        BeginWorkCounter(&chunk->workCounter, PlatformLowPriorityQueue, ChunkMesherWork, chunk, handle, nullptr);
+        if (PlatformPushWorkWithCounter(PlatformLowPriorityQueue, &chunk->workCounter, ChunkFillWork, gen, chunk, handle)) {
+            result = true;
+        } else {
+            // NOTE: Dropping the successor, so releasing the counter doesn't launch it
+            chunk->workCounter.successor = nullptr;
+            chunk->state = ChunkState::Complete;
+        }
+        PlatformReleaseWorkCounter(&chunk->workCounter);
+    } else {
+        if (PlatformPushWork(PlatformLowPriorityQueue, ChunkFillWork, gen, chunk, handle)) {
+            result = true;
+        }
+        else {
+            chunk->state = ChunkState::Complete;
+        }
     }
     return result;
 }
 
-void GenChunk(WorldGen* gen, Chunk* chunk) {
+// NOTE: Blocks of the surface are generated into a flat scratch array and packed into the chunk at once.
+// Everything above and below it is uniform
+void GenChunk(WorldGen* gen, Chunk* chunk, MemoryArena* scratch) {
     if (chunk->p.y == 0) {
+        auto scratchMemory = ScopedTempMemory::Make(scratch);
+        auto blocks = (BlockValue*)PushSize(scratch, sizeof(BlockValue) * Chunk::BlockCount, MemoryArenaFlag_None);
+        memset(blocks, 0, sizeof(BlockValue) * Chunk::BlockCount);
         for (u32 bz = 0; bz < Chunk::Size; bz++) {
             for (u32 bx = 0; bx < Chunk::Size; bx++) {
                 auto wp = ChunkPos::ToWorld(ChunkPos{chunk->p, UV3(bx, 0, bz)});
@@ -107,20 +144,15 @@ void GenChunk(WorldGen* gen, Chunk* chunk) {
                             value = BlockValue::CoalOre;
                         }
                     }
-                    auto block = GetBlockValueRaw(chunk, bx, by, bz);
-                    *block = value;
+                    blocks[bx + Chunk::Size * by + Chunk::Size * Chunk::Size * bz] = value;
                 }
             }
         }
+        PackChunkBlocks(chunk, blocks);
     } else if (chunk->p.y < 0) {
-        for (u32 bz = 0; bz < Chunk::Size; bz++) {
-            for (u32 by = 0; by < Chunk::Size; by++) {
-                for (u32 bx = 0; bx < Chunk::Size; bx++) {
-                    auto block = GetBlockValueRaw(chunk, bx, by, bz);
-                    *block = BlockValue::Stone;
-                }
-            }
-        }
+        SetChunkBlocksUniform(chunk, BlockValue::Stone);
+    } else {
+        SetChunkBlocksUniform(chunk, BlockValue::Empty);
     }
 }
 
@@ -24,6 +24,6 @@ struct WorldGen {
     }
 };
 
-void GenChunk(WorldGen* gen, Chunk* chunk);
+void GenChunk(WorldGen* gen, Chunk* chunk, MemoryArena* scratch);
 bool ScheduleChunkFill(WorldGen* gen, Chunk* chunk);
 void RunNoise2DTest();
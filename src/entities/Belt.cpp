@@ -21,8 +21,7 @@ void DeserializeBeltTrait(BeltTrait* trait, EntitySerializedData data) {
 void OrientBelt(Belt* belt) {
     i32 directions[4] {};
 
-    auto world = GetWorld();
-    ForEachEntityNeighbor(world, belt->p, [&](auto block, auto dir) {
+    ForEachEntityNeighbor(belt, [&](auto block, auto dir) {
         if (block.entity) {
             // TODO: Actually use  trait
             auto neighborBelt = FindEntityTrait<BeltTrait>(block.entity);
@@ -60,9 +59,8 @@ void OrientBelt(Belt* belt) {
 }
 
 Entity* CreateBelt(GameWorld* world, WorldPos p) {
-    Belt* belt = AddBlockEntity<Belt>(world, p.block);
+    Belt* belt = AddBlockEntity<Belt>(world, EntityType::Belt, p.block);
     if (belt) {
-        belt->type = EntityType::Belt;
         belt->dirtyNeighborhood = true;
         belt->belt.direction = Direction::North;
         belt->belt.InsertItem = BeltInsertItem;
@@ -125,8 +123,7 @@ void BeltUpdateAndRender(Belt* belt, void* _data) {
                         trait->itemPositions[i] = max;
                     }
                 } else {
-                    auto to = belt->p + Dir::ToIV3(trait->direction);
-                    auto toEntity = GetBlockEntity(belt->world, to);
+                    auto toEntity = GetNeighborBlockEntity(belt, Dir::ToIV3(trait->direction));
                     if (toEntity) {
                         auto toBelt = FindEntityTrait<BeltTrait>(toEntity);
                         if (toBelt) {
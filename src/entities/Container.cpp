@@ -2,9 +2,8 @@
 #include "RenderGroup.h"
 
 Entity* CreateContainerEntity(GameWorld* world, WorldPos p) {
-    Container* entity = AddBlockEntity<Container>(world, p.block);
+    Container* entity = AddBlockEntity<Container>(world, EntityType::Container, p.block);
     if (entity) {
-        entity->type = EntityType::Container;
         entity->inventory = AllocateEntityInventory(64, 128);
         entity->flags |= EntityFlag_Collides;
         entity->itemExchangeTrait.PushItem = ContainerPushItem;
@@ -1,10 +1,9 @@
 #include "Extractor.h"
 
 Entity* CreateExtractor(GameWorld* world, WorldPos p) {
-    Extractor* extractor = AddBlockEntity<Extractor>(world, p.block);
+    Extractor* extractor = AddBlockEntity<Extractor>(world, EntityType::Extractor, p.block);
     if (extractor) {
         extractor->flags = EntityFlag_Collides;
-        extractor->type = EntityType::Extractor;
         extractor->dirtyNeighborhood = true;
         extractor->direction = Direction::North;
         extractor->itemExchangeTrait.PushItem = ExtractorPushItem;
@@ -26,8 +25,7 @@ void ExtractorUpdateAndRender(Extractor* extractor, void* _data) {
 
     extractor->extractTimeout = Clamp(extractor->extractTimeout - data->deltaTime, 0.0f, Extractor::ExtractTimeout);
     if (extractor->bufferItemID == 0) {
-        auto from = extractor->p + Dir::ToIV3(Dir::Opposite(extractor->direction));
-        auto fromEntity = GetBlockEntity(extractor->world, from);
+        auto fromEntity = GetNeighborBlockEntity(extractor, Dir::ToIV3(Dir::Opposite(extractor->direction)));
         if (extractor->extractTimeout <= 0.0f) {
             if (fromEntity) {
                 auto beltTrait = FindEntityTrait<BeltTrait>(fromEntity);
@@ -48,8 +46,7 @@ void ExtractorUpdateAndRender(Extractor* extractor, void* _data) {
     }
 
     if (extractor->bufferItemID != 0) {
-        auto to = extractor->p + Dir::ToIV3(extractor->direction);
-        auto toEntity = GetBlockEntity(extractor->world, to);
+        auto toEntity = GetNeighborBlockEntity(extractor, Dir::ToIV3(extractor->direction));
         if (toEntity) {
             auto beltTrait = FindEntityTrait<BeltTrait>(toEntity);
             if (beltTrait) {
@@ -13,9 +13,8 @@ Pickup* CreatePickup(WorldPos p, ItemID item, u32 count) {
 }
 
 Entity* CreatePickupEntity(GameWorld* world, WorldPos p) {
-    auto entity = AddSpatialEntity<Pickup>(world, p);
+    auto entity = AddSpatialEntity<Pickup>(world, EntityType::Pickup, p);
     if (entity) {
-        entity->type = EntityType::Pickup;
         entity->scale = Globals::PickupScale;
     }
     return entity;
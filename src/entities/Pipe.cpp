@@ -10,7 +10,7 @@ void NeighborhoodChangedUpdate(Pipe* pipe) {
     auto world = GetWorld();
     OrientPipe(pipe->world, pipe);
 
-    auto downBlock = GetBlock(pipe->world, pipe->p + IV3(0, -1, 0));
+    auto downBlock = GetNeighborBlock(pipe, IV3(0, -1, 0));
     if (downBlock.value == BlockValue::Water) {
         // TODO: Orient pipe to water
         pipe->filled = true;
@@ -39,7 +39,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
             u32 connectionCount = 0;
 
             if (entity->nxConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p - IV3(1, 0, 0));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(-1, 0, 0));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -54,7 +54,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
                 }
             }
             if (entity->pxConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p + IV3(1, 0, 0));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(1, 0, 0));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -69,7 +69,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
                 }
             }
             if (entity->pyConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p + IV3(0, 1, 0));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(0, 1, 0));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -84,7 +84,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
                 }
             }
             if (entity->nyConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p - IV3(0, 1, 0));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(0, -1, 0));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -99,7 +99,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
                 }
             }
             if (entity->pzConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p + IV3(0, 0, 1));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(0, 0, 1));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -114,7 +114,7 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
                 }
             }
             if (entity->nzConnected) {
-                BlockEntity* _neighbor = GetBlockEntity(entity->world, entity->p - IV3(0, 0, 1));
+                BlockEntity* _neighbor = GetNeighborBlockEntity(entity, IV3(0, 0, -1));
                 if (_neighbor->type == EntityType::Pipe) {
                     auto neighbor = static_cast<Pipe*>(_neighbor);
                     if (neighbor && neighbor->liquid == entity->liquid) {
@@ -145,9 +145,8 @@ void PipeUpdateAndRender(Entity* _entity, EntityBehaviorInvoke reason, void* _da
 }
 
 Entity* CreatePipeEntity(GameWorld* world, WorldPos p) {
-    Pipe* pipe = AddBlockEntity<Pipe>(world, p.block);
+    Pipe* pipe = AddBlockEntity<Pipe>(world, EntityType::Pipe, p.block);
     if (pipe) {
-        pipe->type = EntityType::Pipe;
         pipe->flags |= EntityFlag_Collides;
         pipe->dirtyNeighborhood = true;
     }
@@ -179,16 +178,15 @@ void PipeUpdateAndRenderUI(Entity* entity, EntityUIInvoke reason) {
 // This proc is crazy mess for now. We need some smart algorithm for orienting pipes
 void OrientPipe(GameWorld* world, Pipe* pipe) {
     auto context = GetContext();
-    iv3 p = pipe->p;
     pipe->mesh = context->pipeStraightMesh;
 
     // TODO: Be carefull with pointers in blocks
-    BlockEntity* westNeighbour = GetBlockEntity(world, p + IV3(-1, 0, 0));
-    BlockEntity* eastNeighbour = GetBlockEntity(world, p + IV3(1, 0, 0));
-    BlockEntity* northNeighbour = GetBlockEntity(world, p + IV3(0, 0, -1));
-    BlockEntity* southNeighbour = GetBlockEntity(world, p + IV3(0, 0, 1));
-    BlockEntity* upNeighbour = GetBlockEntity(world, p + IV3(0, 1, 0));
-    BlockEntity* downNeighbour = GetBlockEntity(world, p + IV3(0, -1, 0));
+    BlockEntity* westNeighbour = GetNeighborBlockEntity(pipe, IV3(-1, 0, 0));
+    BlockEntity* eastNeighbour = GetNeighborBlockEntity(pipe, IV3(1, 0, 0));
+    BlockEntity* northNeighbour = GetNeighborBlockEntity(pipe, IV3(0, 0, -1));
+    BlockEntity* southNeighbour = GetNeighborBlockEntity(pipe, IV3(0, 0, 1));
+    BlockEntity* upNeighbour = GetNeighborBlockEntity(pipe, IV3(0, 1, 0));
+    BlockEntity* downNeighbour = GetNeighborBlockEntity(pipe, IV3(0, -1, 0));
 
     bool px = 0;
     bool nx = 0;
@@ -1,9 +1,8 @@
 #include "Player.h"
 
 Entity* CreatePlayerEntity(GameWorld* world, WorldPos p) {
-    Player* entity = AddSpatialEntity<Player>(world, p);
+    Player* entity = AddSpatialEntity<Player>(world, EntityType::Player, p);
     if (entity) {
-        entity->type = EntityType::Player;
         entity->flags |= EntityFlag_ProcessOverlaps | EntityFlag_DisableDeleteWhenOutsideOfWorldBounds;
         entity->scale = 0.95f;
         entity->acceleration = 70.0f;
@@ -8,9 +8,8 @@ Projectile* CreateProjectile(WorldPos p) {
 }
 
 Entity* CreateProjectileEntity(GameWorld* world, WorldPos p) {
-    auto entity = AddSpatialEntity<Projectile>(world, p);
+    auto entity = AddSpatialEntity<Projectile>(world, EntityType::Projectile, p);
     if (entity) {
-        entity->type = EntityType::Projectile;
         entity->scale = Globals::PickupScale;
     }
     return entity;
@@ -21,16 +20,16 @@ void ProjectileCollisionResponse(SpatialEntity* entity, const CollisionInfo* inf
     auto p = projectile->p.block;
     auto radius = 4;
     auto radiusSq = radius * radius;
+    auto cursor = MakeBlockCursor(projectile->world, projectile->chunk, p);
     for (i32 z = p.z - radius; z < (p.z + radius); z++) {
         for (i32 y = p.y - radius; y < (p.y + radius); y++) {
             for (i32 x = p.x - radius; x < (p.x + radius); x++) {
                 auto pi = IV3(x, y, z);
                 if (LengthSq(pi - p) <= radiusSq) {
-                    auto chunkP = WorldPos::ToChunk(pi);
-                    auto chunk = GetChunk(projectile->world, chunkP.chunk);
+                    SetBlockCursor(&cursor, pi);
+                    auto chunk = GetChunk(&cursor);
                     if (chunk) {
-                        auto blockValue = GetBlockForModification(chunk, chunkP.block.x, chunkP.block.y, chunkP.block.z);
-                        *blockValue = BlockValue::Empty;
+                        ModifyBlock(chunk, cursor.block.x, cursor.block.y, cursor.block.z, BlockValue::Empty);
                     }
                 }
             }
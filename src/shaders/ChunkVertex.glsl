@@ -1,10 +1,8 @@
 #version 450
 #include Common.glh
 
-layout (location = 0) in vec3 Position;
-layout (location = 1) in vec3 Normal;
-layout (location = 2) in vec3 Tangent;
-layout (location = 3) in uint VoxelValue;
+layout (location = 0) in uint PackedVertex;
+layout (location = 1) in uint VoxelValue;
 
 layout (location = 4) out VertOut {
     flat uint voxelValue;
@@ -22,19 +20,27 @@ layout (location = 0) uniform vec3 Offset;
 #define INDICES_PER_CHUNK_QUAD 6
 #define VERTICES_PER_QUAD 4
 
-vec2 UV[] = vec2[](vec2(0.0f, 0.0f),
-                   vec2(1.0f, 0.0f),
-                   vec2(1.0f, 1.0f),
-                   vec2(0.0f, 1.0f));
+// NOTE: Indexed with the face of the packed vertex. Must match ChunkSideOffsets and BoxFaceTangents
+const vec3 FaceNormals[6] = vec3[6](vec3(0.0f, 1.0f, 0.0f), vec3(0.0f, -1.0f, 0.0f), vec3(-1.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f));
+const vec3 FaceTangents[6] = vec3[6](vec3(1.0f, 0.0f, 0.0f), vec3(1.0f, 0.0f, 0.0f), vec3(0.0f, 0.0f, 1.0f), vec3(0.0f, 0.0f, -1.0f), vec3(1.0f, 0.0f, 0.0f), vec3(-1.0f, 0.0f, 0.0f));
+
 void main()
 {
-    int vertIndexInQuad = gl_VertexID % 4;
+    // NOTE: Unpacking ChunkVertex. Position is a block corner, blocks are one unit wide and centered at integer coords
+    uvec3 corner = uvec3(PackedVertex, PackedVertex >> 6, PackedVertex >> 12) & 0x3fu;
+    uint face = (PackedVertex >> 18) & 0x7u;
+    vec3 Position = vec3(corner) - 0.5f;
+    vec3 normal = FaceNormals[face];
+    vec3 tangent = FaceTangents[face];
 
-    vertOut.uv = UV[min(vertIndexInQuad, VERTICES_PER_QUAD - 1)];
+    // NOTE: Texture coordinates are projected from the position on the face plane, so faces
+    // merged by the greedy mesher repeat the texture once per block. Block corners are at half coords
+    vec3 bitangent = cross(normal, tangent);
+    vertOut.uv = vec2(dot(Position, tangent), dot(Position, bitangent)) + 0.5f;
 
     vertOut.voxelValue = VoxelValue;
     vertOut.position = Position + Offset;
-    vertOut.normal = Normal;
+    vertOut.normal = normal;
     vertOut.viewSpacePos = (FrameData.viewMatrix * vec4(vertOut.position, 1.0f)).xyz;
     vertOut.lightSpacePos[0] = FrameData.lightSpaceMatrices[0] * vec4(vertOut.position, 1.0f);
     vertOut.lightSpacePos[1] = FrameData.lightSpaceMatrices[1] * vec4(vertOut.position, 1.0f);